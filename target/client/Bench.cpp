@@ -0,0 +1,738 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "../common/crypto/DesCipher.h"
+#include "../common/net/FramedIO.h"
+#include "../common/protocol/JsonLite.h"
+#include "../common/protocol/Message.h"
+#include "../common/utils/Base64.h"
+
+namespace client {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Op {
+    Ping = 0,
+    List,
+    Upload,
+    Download,
+    Count
+};
+constexpr size_t kOpCount = static_cast<size_t>(Op::Count);
+constexpr std::array<const char*, kOpCount> kOpNames = {"ping", "list", "upload", "download"};
+
+enum class Outcome {
+    Ok,
+    Rejected,   // ok=false, or a reply the client cannot decode
+    Failed      // transport or protocol failure; the connection is unusable
+};
+
+struct OpStats {
+    // Microseconds. latency is measured from the scheduled start, service
+    // from the actual send; they only differ in open-loop runs.
+    std::vector<uint32_t> latencyUs;
+    std::vector<uint32_t> serviceUs;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+};
+
+struct WorkerResult {
+    std::array<OpStats, kOpCount> ops;
+    bool failed = false;
+    std::string err;
+};
+
+// Inputs shared read-only by all workers.
+struct BenchPlan {
+    const BenchOptions* options = nullptr;
+    std::string serverIp;
+    std::vector<uint8_t> desKey;
+    std::vector<uint8_t> uploadData;
+    std::string seedName;
+    std::string nameTag;
+};
+
+bool ParseUint(std::string_view text, uint64_t& out) {
+    if (text.empty()) {
+        return false;
+    }
+    uint64_t v = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    out = v;
+    return true;
+}
+
+// "64k", "1m" and plain byte counts.
+bool ParseSize(std::string_view text, uint64_t& out) {
+    uint64_t scale = 1;
+    if (!text.empty()) {
+        const char unit = text.back();
+        if (unit == 'k' || unit == 'K') {
+            scale = 1024;
+        } else if (unit == 'm' || unit == 'M') {
+            scale = 1024 * 1024;
+        }
+        if (scale != 1) {
+            text.remove_suffix(1);
+        }
+    }
+    if (!ParseUint(text, out)) {
+        return false;
+    }
+    out *= scale;
+    return true;
+}
+
+// "ping=8,list=1,upload=1": weights of the listed operations; others are 0.
+bool ParseMix(std::string_view text, BenchOptions& out) {
+    std::array<uint64_t, kOpCount> weights{};
+    while (!text.empty()) {
+        const size_t comma = text.find(',');
+        const std::string_view item = text.substr(0, comma);
+        text = (comma == std::string_view::npos) ? std::string_view() : text.substr(comma + 1);
+
+        const size_t eq = item.find('=');
+        const std::string_view name = item.substr(0, eq);
+        uint64_t weight = 1;
+        if (eq != std::string_view::npos && !ParseUint(item.substr(eq + 1), weight)) {
+            return false;
+        }
+        size_t op = 0;
+        while (op < kOpCount && name != kOpNames[op]) {
+            ++op;
+        }
+        if (op == kOpCount || weight > 1000000) {
+            return false;
+        }
+        weights[op] = weight;
+    }
+    out.weightPing = static_cast<uint32_t>(weights[static_cast<size_t>(Op::Ping)]);
+    out.weightList = static_cast<uint32_t>(weights[static_cast<size_t>(Op::List)]);
+    out.weightUpload = static_cast<uint32_t>(weights[static_cast<size_t>(Op::Upload)]);
+    out.weightDownload = static_cast<uint32_t>(weights[static_cast<size_t>(Op::Download)]);
+    return out.weightPing + out.weightList + out.weightUpload + out.weightDownload > 0;
+}
+
+class Connection {
+public:
+    ~Connection() {
+        if (s_ != INVALID_SOCKET) {
+            closesocket(s_);
+        }
+    }
+
+    bool Open(const std::string& ip, std::string& err) {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(9000);
+        if (InetPtonA(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+            err = "invalid server ip";
+            return false;
+        }
+        s_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (s_ == INVALID_SOCKET) {
+            err = "socket() failed";
+            return false;
+        }
+        if (connect(s_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            err = "connect() failed";
+            return false;
+        }
+        return true;
+    }
+
+    // Sends `req` and decodes the reply into resp(). The frame buffers are
+    // reused across calls.
+    Outcome Call(const protocol::RequestMessage& req) {
+        net::beginFrame(reqFrame_);
+        if (!protocol::AppendRequest(req, reqFrame_) || !net::sendFrameBuffer(s_, reqFrame_) ||
+            !net::recvFrame(s_, respFrame_)) {
+            return Outcome::Failed;
+        }
+        // The frame was read in full, so the connection stays usable even if
+        // the reply exceeds the client's JSON limits (e.g. LIST_FILES with
+        // more than 64 files).
+        protocol::ErrorCode parseErr = protocol::ErrorCode::Ok;
+        if (!protocol::DecodeResponse(respFrame_, resp_, parseErr)) {
+            resp_ = protocol::ResponseMessage();
+            resp_.msg = "undecodable response";
+            return Outcome::Rejected;
+        }
+        return resp_.ok ? Outcome::Ok : Outcome::Rejected;
+    }
+
+    const protocol::ResponseMessage& resp() const { return resp_; }
+
+private:
+    SOCKET s_ = INVALID_SOCKET;
+    std::string reqFrame_;
+    std::string respFrame_;
+    protocol::ResponseMessage resp_;
+};
+
+bool Login(Connection& conn, const BenchPlan& plan, std::string& err) {
+    const BenchOptions& o = *plan.options;
+    if (!o.user.empty()) {
+        protocol::RequestMessage req;
+        req.cmd = "LOGIN_LOW";
+        req.args.fields["username"] = protocol::MakeString(o.user);
+        req.args.fields["password"] = protocol::MakeString(o.pass);
+        if (conn.Call(req) != Outcome::Ok) {
+            err = "LOGIN_LOW failed: " + conn.resp().msg;
+            return false;
+        }
+    }
+    if (!o.adminUser.empty()) {
+        std::string cipherHex;
+        if (!crypto::DesEncryptEcbPkcs7Hex(o.adminPass, plan.desKey, cipherHex, err)) {
+            return false;
+        }
+        protocol::RequestMessage req;
+        req.cmd = "LOGIN_HIGH";
+        req.args.fields["username"] = protocol::MakeString(o.adminUser);
+        req.args.fields["password_cipher_hex"] = protocol::MakeString(cipherHex);
+        if (conn.Call(req) != Outcome::Ok) {
+            err = "LOGIN_HIGH failed: " + conn.resp().msg;
+            return false;
+        }
+    }
+    return true;
+}
+
+Outcome RunSimple(Connection& conn, const char* cmd) {
+    protocol::RequestMessage req;
+    req.cmd = cmd;
+    return conn.Call(req);
+}
+
+Outcome RunUpload(Connection& conn, const BenchPlan& plan, const std::string& name, uint64_t& bytes) {
+    const BenchOptions& o = *plan.options;
+    protocol::RequestMessage req;
+    req.cmd = "UPLOAD_INIT";
+    req.args.fields["filename"] = protocol::MakeString(name);
+    req.args.fields["file_size"] = protocol::MakeNumber(static_cast<int64_t>(o.uploadBytes));
+    req.args.fields["chunk_size"] = protocol::MakeNumber(static_cast<int64_t>(o.chunkBytes));
+    Outcome r = conn.Call(req);
+    if (r != Outcome::Ok) {
+        return r;
+    }
+    std::string uploadId;
+    int64_t chunkSize = 0;
+    if (!protocol::GetString(conn.resp().data, "upload_id", uploadId) ||
+        !protocol::GetNumber(conn.resp().data, "chunk_size", chunkSize) || chunkSize <= 0) {
+        return Outcome::Failed;
+    }
+
+    // Split by the chunk size the server granted, which is capped at its
+    // max_chunk_bytes and may be smaller than --chunk. Chunks are encoded
+    // here like a real client would, so client-side cost is included.
+    const std::vector<uint8_t>& data = plan.uploadData;
+    const size_t step = static_cast<size_t>(chunkSize);
+    for (size_t off = 0, index = 0; off < data.size(); off += step, ++index) {
+        const size_t len = std::min(step, data.size() - off);
+        req.cmd = "UPLOAD_CHUNK";
+        req.args.fields.clear();
+        req.args.fields["upload_id"] = protocol::MakeString(uploadId);
+        req.args.fields["chunk_index"] = protocol::MakeNumber(static_cast<int64_t>(index));
+        req.args.fields["data_b64"] = protocol::MakeString(util::Base64Encode(data.data() + off, len));
+        if ((r = conn.Call(req)) != Outcome::Ok) {
+            if (r == Outcome::Rejected) {
+                // A rejected chunk leaves the upload open on the server; an
+                // early UPLOAD_FINISH fails with a size mismatch and resets
+                // it, so the next UPLOAD_INIT on this connection succeeds.
+                req.cmd = "UPLOAD_FINISH";
+                req.args.fields.clear();
+                req.args.fields["upload_id"] = protocol::MakeString(uploadId);
+                if (conn.Call(req) == Outcome::Failed) {
+                    return Outcome::Failed;
+                }
+            }
+            return r;
+        }
+    }
+
+    req.cmd = "UPLOAD_FINISH";
+    req.args.fields.clear();
+    req.args.fields["upload_id"] = protocol::MakeString(uploadId);
+    if ((r = conn.Call(req)) == Outcome::Ok) {
+        bytes += o.uploadBytes;
+    }
+    return r;
+}
+
+Outcome RunDownload(Connection& conn, const BenchPlan& plan, std::vector<uint8_t>& scratch, uint64_t& bytes) {
+    protocol::RequestMessage req;
+    req.cmd = "DOWNLOAD_INIT";
+    req.args.fields["filename"] = protocol::MakeString(plan.seedName);
+    req.args.fields["chunk_size"] = protocol::MakeNumber(static_cast<int64_t>(plan.options->chunkBytes));
+    Outcome r = conn.Call(req);
+    if (r != Outcome::Ok) {
+        return r;
+    }
+    std::string downloadId;
+    if (!protocol::GetString(conn.resp().data, "download_id", downloadId)) {
+        return Outcome::Failed;
+    }
+
+    for (int64_t index = 0;; ++index) {
+        req.cmd = "DOWNLOAD_CHUNK";
+        req.args.fields.clear();
+        req.args.fields["download_id"] = protocol::MakeString(downloadId);
+        req.args.fields["chunk_index"] = protocol::MakeNumber(index);
+        if ((r = conn.Call(req)) != Outcome::Ok) {
+            return r;
+        }
+        const std::string* dataB64 = protocol::FindString(conn.resp().data, "data_b64");
+        bool isLast = false;
+        if (!dataB64 || !protocol::GetBool(conn.resp().data, "is_last", isLast)) {
+            return Outcome::Failed;
+        }
+        // Decoded like a real client would, so client-side cost is included.
+        scratch.resize(util::Base64DecodedMaxSize(dataB64->size()));
+        size_t decoded = 0;
+        if (!util::Base64Decode(dataB64->data(), dataB64->size(), scratch.data(), scratch.size(), decoded)) {
+            return Outcome::Failed;
+        }
+        bytes += decoded;
+        if (isLast) {
+            return Outcome::Ok;
+        }
+    }
+}
+
+uint32_t ClampUs(Clock::duration d) {
+    const int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return static_cast<uint32_t>(std::clamp<int64_t>(us, 0, UINT32_MAX));
+}
+
+void RunWorker(size_t index, const BenchPlan& plan, Clock::time_point start, Clock::time_point end,
+               WorkerResult& out) {
+    const BenchOptions& o = *plan.options;
+    Connection conn;
+    if (!conn.Open(plan.serverIp, out.err) || !Login(conn, plan, out.err)) {
+        out.failed = true;
+        return;
+    }
+
+    const std::array<uint32_t, kOpCount> weights = {o.weightPing, o.weightList, o.weightUpload, o.weightDownload};
+    uint64_t totalWeight = 0;
+    for (uint32_t w : weights) {
+        totalWeight += w;
+    }
+    // Fixed seed per connection keeps the operation sequence reproducible.
+    uint64_t rng = 0x9E3779B97F4A7C15ull * (index + 1);
+
+    // Open loop: request k of this connection is due at start + offset +
+    // k * interval, whether or not the previous one has finished.
+    const bool openLoop = o.rate > 0;
+    const auto interval = openLoop
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(o.connections / o.rate))
+        : Clock::duration::zero();
+    const Clock::time_point first = start + interval * static_cast<int64_t>(index) / o.connections;
+
+    std::vector<uint8_t> scratch;
+    for (uint64_t k = 0;; ++k) {
+        Clock::time_point due = openLoop ? first + interval * static_cast<int64_t>(k) : Clock::now();
+        if (due >= end) {
+            break;
+        }
+        if (openLoop) {
+            std::this_thread::sleep_until(due);
+        }
+
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        uint64_t pick = rng % totalWeight;
+        size_t op = 0;
+        while (pick >= weights[op]) {
+            pick -= weights[op];
+            ++op;
+        }
+
+        OpStats& stats = out.ops[op];
+        const Clock::time_point sent = Clock::now();
+        Outcome r = Outcome::Ok;
+        switch (static_cast<Op>(op)) {
+        case Op::Ping:
+            r = RunSimple(conn, "PING");
+            break;
+        case Op::List:
+            r = RunSimple(conn, "LIST_FILES");
+            break;
+        case Op::Upload:
+            r = RunUpload(conn, plan,
+                          "bench_" + plan.nameTag + "_" + std::to_string(index) + "_" + std::to_string(k) + ".bin",
+                          stats.bytes);
+            break;
+        case Op::Download:
+            r = RunDownload(conn, plan, scratch, stats.bytes);
+            break;
+        case Op::Count:
+            break;
+        }
+        const Clock::time_point done = Clock::now();
+
+        if (!openLoop) {
+            due = sent;
+        }
+        stats.latencyUs.push_back(ClampUs(done - due));
+        stats.serviceUs.push_back(ClampUs(done - sent));
+        if (r != Outcome::Ok) {
+            ++stats.errors;
+        }
+        if (r == Outcome::Failed) {
+            out.failed = true;
+            out.err = "connection failed";
+            return;
+        }
+    }
+}
+
+// Uploads the file every download operation fetches.
+bool PrepareSeed(BenchPlan& plan, std::string& err) {
+    const BenchOptions& o = *plan.options;
+    if (o.weightUpload > 0) {
+        std::vector<uint8_t> data(static_cast<size_t>(o.uploadBytes));
+        uint32_t x = 2463534242u;
+        for (auto& b : data) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            b = static_cast<uint8_t>(x);
+        }
+        plan.uploadData = std::move(data);
+    }
+    if (o.weightDownload == 0) {
+        return true;
+    }
+
+    Connection conn;
+    if (!conn.Open(plan.serverIp, err) || !Login(conn, plan, err)) {
+        return false;
+    }
+    BenchPlan seed = plan;
+    BenchOptions seedOptions = o;
+    seedOptions.uploadBytes = o.downloadBytes;
+    seed.options = &seedOptions;
+    seed.uploadData.assign(static_cast<size_t>(o.downloadBytes), 0x5A);
+    uint64_t bytes = 0;
+    if (RunUpload(conn, seed, plan.seedName, bytes) != Outcome::Ok) {
+        err = "seed upload failed: " + conn.resp().msg;
+        return false;
+    }
+    return true;
+}
+
+struct Summary {
+    uint64_t count = 0;
+    uint64_t errors = 0;
+    uint64_t bytes = 0;
+    std::array<uint32_t, 5> latency{};   // p50 p90 p99 p99.9 max
+    std::array<uint32_t, 5> service{};
+};
+
+constexpr std::array<double, 4> kQuantiles = {0.50, 0.90, 0.99, 0.999};
+constexpr std::array<const char*, 5> kQuantileNames = {"p50", "p90", "p99", "p999", "max"};
+
+std::array<uint32_t, 5> Percentiles(std::vector<uint32_t>& v) {
+    std::array<uint32_t, 5> out{};
+    if (v.empty()) {
+        return out;
+    }
+    std::sort(v.begin(), v.end());
+    for (size_t i = 0; i < kQuantiles.size(); ++i) {
+        const size_t rank = static_cast<size_t>(kQuantiles[i] * static_cast<double>(v.size()) + 0.999999);
+        out[i] = v[std::min(v.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+    out[4] = v.back();
+    return out;
+}
+
+Summary Summarize(std::vector<uint32_t> latency, std::vector<uint32_t> service, uint64_t errors, uint64_t bytes) {
+    Summary s;
+    s.count = latency.size();
+    s.errors = errors;
+    s.bytes = bytes;
+    s.latency = Percentiles(latency);
+    s.service = Percentiles(service);
+    return s;
+}
+
+void AppendSummaryJson(const char* name, const Summary& s, double seconds, std::string& out) {
+    out += "{\"op\":\"";
+    out += name;
+    out += "\",\"count\":";
+    protocol::AppendJsonNumber(static_cast<int64_t>(s.count), out);
+    out += ",\"errors\":";
+    protocol::AppendJsonNumber(static_cast<int64_t>(s.errors), out);
+    out += ",\"ops_per_s\":";
+    protocol::AppendJsonNumber(static_cast<int64_t>(static_cast<double>(s.count) / seconds), out);
+    out += ",\"bytes\":";
+    protocol::AppendJsonNumber(static_cast<int64_t>(s.bytes), out);
+    const std::array<std::pair<const char*, const std::array<uint32_t, 5>*>, 2> groups = {{
+        {"latency_us", &s.latency}, {"service_us", &s.service}}};
+    for (const auto& [key, values] : groups) {
+        out += ",\"";
+        out += key;
+        out += "\":{";
+        for (size_t i = 0; i < values->size(); ++i) {
+            if (i) {
+                out += ',';
+            }
+            out += '"';
+            out += kQuantileNames[i];
+            out += "\":";
+            protocol::AppendJsonNumber((*values)[i], out);
+        }
+        out += '}';
+    }
+    out += '}';
+}
+
+std::string FormatMs(uint32_t us) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3) << us / 1000.0;
+    return oss.str();
+}
+
+void PrintRow(const char* name, const Summary& s, double seconds) {
+    std::cout << std::left << std::setw(10) << name << std::right
+              << std::setw(10) << s.count
+              << std::setw(8) << s.errors
+              << std::setw(11) << std::fixed << std::setprecision(1) << static_cast<double>(s.count) / seconds
+              << std::setw(10) << std::setprecision(2) << static_cast<double>(s.bytes) / seconds / (1024 * 1024);
+    for (uint32_t v : s.latency) {
+        std::cout << std::setw(10) << FormatMs(v);
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+void PrintBenchUsage() {
+    std::cout
+        << "Bench options (after --bench):\n"
+        << "  --connections <n>        parallel connections (default 4)\n"
+        << "  --duration <seconds>     run time (default 10)\n"
+        << "  --rate <ops/s>           open loop at this total rate; omit for closed loop\n"
+        << "  --mix <op=w,...>         ops: ping, list, upload, download (default ping=1)\n"
+        << "  --upload-size <bytes>    bytes per upload, k/m suffix allowed (default 64k)\n"
+        << "  --download-size <bytes>  bytes per download (default 64k)\n"
+        << "  --chunk <bytes>          transfer chunk size (default 64k)\n"
+        << "  --login <user> <pass>    LOGIN_LOW on every connection\n"
+        << "  --admin <user> <pass>    LOGIN_HIGH as well (needed by list/upload/download)\n"
+        << "  --json <path|->          also write the results as JSON\n"
+        << "  --ip <server_ip>         same as --ip before --bench\n";
+}
+
+bool ParseBenchArgs(int argc, char** argv, int first, BenchOptions& out, std::string& err) {
+    static constexpr std::array<std::string_view, 11> kKnown = {
+        "--connections", "--duration", "--rate", "--mix", "--upload-size", "--download-size",
+        "--chunk", "--login", "--admin", "--json", "--ip"};
+    for (int i = first; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (std::find(kKnown.begin(), kKnown.end(), arg) == kKnown.end()) {
+            err = "Unknown bench argument: " + std::string(arg);
+            return false;
+        }
+        const int need = (arg == "--login" || arg == "--admin") ? 2 : 1;
+        if (i + need >= argc) {
+            err = "Missing value after " + std::string(arg);
+            return false;
+        }
+        const std::string_view value = argv[i + 1];
+        uint64_t n = 0;
+        bool ok = true;
+        if (arg == "--connections") {
+            ok = ParseUint(value, n) && n > 0 && n <= 1024;
+            out.connections = static_cast<uint32_t>(n);
+        } else if (arg == "--duration") {
+            ok = ParseUint(value, n) && n > 0;
+            out.durationSec = static_cast<uint32_t>(n);
+        } else if (arg == "--rate") {
+            char* endp = nullptr;
+            const std::string text(value);
+            out.rate = std::strtod(text.c_str(), &endp);
+            ok = endp != text.c_str() && *endp == '\0' && out.rate > 0;
+        } else if (arg == "--mix") {
+            ok = ParseMix(value, out);
+        } else if (arg == "--upload-size") {
+            ok = ParseSize(value, out.uploadBytes) && out.uploadBytes > 0;
+        } else if (arg == "--download-size") {
+            ok = ParseSize(value, out.downloadBytes) && out.downloadBytes > 0;
+        } else if (arg == "--chunk") {
+            ok = ParseSize(value, n) && n > 0 && n <= 64 * 1024;
+            out.chunkBytes = static_cast<uint32_t>(n);
+        } else if (arg == "--login") {
+            out.user = argv[i + 1];
+            out.pass = argv[i + 2];
+        } else if (arg == "--admin") {
+            out.adminUser = argv[i + 1];
+            out.adminPass = argv[i + 2];
+        } else if (arg == "--json") {
+            out.jsonPath = argv[i + 1];
+        } else {
+            out.serverIp = argv[i + 1];
+        }
+        if (!ok) {
+            err = "Invalid value for " + std::string(arg) + ": " + std::string(value);
+            return false;
+        }
+        i += need;
+    }
+    if (!out.adminUser.empty() && out.user.empty()) {
+        err = "--admin needs --login (LOGIN_HIGH requires a LOW session)";
+        return false;
+    }
+    return true;
+}
+
+int RunBench(const BenchOptions& options,
+             const std::string& serverIp,
+             const std::vector<uint8_t>& desKey) {
+    BenchPlan plan;
+    plan.options = &options;
+    plan.serverIp = options.serverIp.empty() ? serverIp : options.serverIp;
+    plan.desKey = desKey;
+    plan.nameTag = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    plan.seedName = "bench_seed_" + plan.nameTag + ".bin";
+
+    std::string err;
+    if (!PrepareSeed(plan, err)) {
+        std::cerr << "bench setup failed: " << err << "\n";
+        return 1;
+    }
+
+    std::cout << "bench: " << options.connections << " connections, " << options.durationSec << " s, ";
+    if (options.rate > 0) {
+        std::cout << "open loop at " << options.rate << " ops/s\n";
+    } else {
+        std::cout << "closed loop\n";
+    }
+
+    std::vector<WorkerResult> results(options.connections);
+    std::vector<std::thread> threads;
+    threads.reserve(options.connections);
+    const Clock::time_point start = Clock::now() + std::chrono::milliseconds(100);
+    const Clock::time_point end = start + std::chrono::seconds(options.durationSec);
+    for (size_t i = 0; i < options.connections; ++i) {
+        threads.emplace_back(RunWorker, i, std::cref(plan), start, end, std::ref(results[i]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(
+        std::max(Clock::now(), end) - start).count();
+
+    size_t failedConnections = 0;
+    std::array<Summary, kOpCount> perOp;
+    std::vector<uint32_t> allLatency;
+    std::vector<uint32_t> allService;
+    uint64_t allErrors = 0;
+    uint64_t allBytes = 0;
+    for (size_t op = 0; op < kOpCount; ++op) {
+        std::vector<uint32_t> latency;
+        std::vector<uint32_t> service;
+        uint64_t errors = 0;
+        uint64_t bytes = 0;
+        for (const WorkerResult& r : results) {
+            const OpStats& s = r.ops[op];
+            latency.insert(latency.end(), s.latencyUs.begin(), s.latencyUs.end());
+            service.insert(service.end(), s.serviceUs.begin(), s.serviceUs.end());
+            errors += s.errors;
+            bytes += s.bytes;
+        }
+        allLatency.insert(allLatency.end(), latency.begin(), latency.end());
+        allService.insert(allService.end(), service.begin(), service.end());
+        allErrors += errors;
+        allBytes += bytes;
+        perOp[op] = Summarize(std::move(latency), std::move(service), errors, bytes);
+    }
+    for (const WorkerResult& r : results) {
+        if (r.failed) {
+            ++failedConnections;
+            std::cerr << "connection error: " << r.err << "\n";
+        }
+    }
+    const Summary total = Summarize(std::move(allLatency), std::move(allService), allErrors, allBytes);
+
+    std::cout << std::left << std::setw(10) << "op" << std::right
+              << std::setw(10) << "count" << std::setw(8) << "errors"
+              << std::setw(11) << "ops/s" << std::setw(10) << "MiB/s"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms"
+              << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << "\n";
+    for (size_t op = 0; op < kOpCount; ++op) {
+        if (perOp[op].count != 0) {
+            PrintRow(kOpNames[op], perOp[op], seconds);
+        }
+    }
+    PrintRow("total", total, seconds);
+    if (options.rate > 0) {
+        std::cout << "latency is measured from the scheduled send time; service p99 "
+                  << FormatMs(total.service[2]) << " ms\n";
+    }
+    if (failedConnections != 0) {
+        std::cout << failedConnections << " connection(s) failed\n";
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::string json = "{\"connections\":";
+        protocol::AppendJsonNumber(options.connections, json);
+        json += ",\"duration_s\":";
+        protocol::AppendJsonNumber(options.durationSec, json);
+        json += ",\"target_rate\":";
+        protocol::AppendJsonNumber(static_cast<int64_t>(options.rate), json);
+        json += ",\"failed_connections\":";
+        protocol::AppendJsonNumber(static_cast<int64_t>(failedConnections), json);
+        json += ",\"ops\":[";
+        bool firstOp = true;
+        for (size_t op = 0; op < kOpCount; ++op) {
+            if (perOp[op].count == 0) {
+                continue;
+            }
+            if (!firstOp) {
+                json += ',';
+            }
+            firstOp = false;
+            AppendSummaryJson(kOpNames[op], perOp[op], seconds, json);
+        }
+        json += "],\"total\":";
+        AppendSummaryJson("total", total, seconds, json);
+        json += "}\n";
+        if (options.jsonPath == "-") {
+            std::cout << json;
+        } else {
+            std::ofstream fout(options.jsonPath, std::ios::binary | std::ios::trunc);
+            fout << json;
+            if (!fout) {
+                std::cerr << "failed to write " << options.jsonPath << "\n";
+                return 1;
+            }
+        }
+    }
+    return (failedConnections != 0 || total.errors != 0) ? 2 : 0;
+}
+
+} // namespace client
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace client {
+
+// Load generator behind `Client --bench`. Each connection runs its own
+// thread and picks operations from a weighted mix. Without --rate every
+// connection sends back to back (closed loop). With --rate the requests
+// follow a fixed schedule (open loop), and latency is measured from each
+// request's scheduled start rather than from when it was actually sent. A
+// server stall then shows up in the percentiles instead of silently
+// lowering the send rate (coordinated omission).
+struct BenchOptions {
+    uint32_t connections = 4;
+    uint32_t durationSec = 10;
+    // Total requests per second across all connections; 0 = closed loop.
+    double rate = 0;
+    // Relative weights of ping, list (LIST_FILES), upload and download.
+    uint32_t weightPing = 1;
+    uint32_t weightList = 0;
+    uint32_t weightUpload = 0;
+    uint32_t weightDownload = 0;
+    // Bytes per upload/download operation and per chunk.
+    uint64_t uploadBytes = 64 * 1024;
+    uint64_t downloadBytes = 64 * 1024;
+    uint32_t chunkBytes = 64 * 1024;
+    // LIST_FILES and transfers need HIGH; login is skipped when unset.
+    std::string user;
+    std::string pass;
+    std::string adminUser;
+    std::string adminPass;
+    // Writes the results as JSON here as well; "-" for stdout.
+    std::string jsonPath;
+    // Overrides the server address from --ip or the config when set.
+    std::string serverIp;
+};
+
+void PrintBenchUsage();
+
+// Parses the arguments after --bench. Returns false with `err` set on an
+// unknown option or a bad value.
+bool ParseBenchArgs(int argc, char** argv, int first, BenchOptions& out, std::string& err);
+
+// Runs the benchmark and prints the report; returns the process exit code.
+int RunBench(const BenchOptions& options,
+             const std::string& serverIp,
+             const std::vector<uint8_t>& desKey);
+
+} // namespace client
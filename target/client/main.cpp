@@ -17,6 +17,7 @@
 #include "../common/protocol/JsonLite.h"
 #include "../common/crypto/DesCipher.h"
 #include "../common/utils/Base64.h"
+#include "Bench.h"
 
 namespace {
 
@@ -30,10 +31,13 @@ struct ClientArgs {
     bool hasServerIp = false;
     std::string serverIp;
     bool showHelp = false;
+    bool bench = false;
+    client::BenchOptions benchOptions;
 };
 
 void PrintUsage() {
-    std::cout << "Usage: Client [--ip <server_ip>]\n";
+    std::cout << "Usage: Client [--ip <server_ip>] [--bench ...]\n";
+    client::PrintBenchUsage();
 }
 
 bool ParseArgs(int argc, char** argv, ClientArgs& out) {
@@ -52,6 +56,16 @@ bool ParseArgs(int argc, char** argv, ClientArgs& out) {
             out.serverIp = argv[++i];
             continue;
         }
+        if (arg == "--bench") {
+            // Everything after --bench belongs to the benchmark.
+            out.bench = true;
+            std::string err;
+            if (!client::ParseBenchArgs(argc, argv, i + 1, out.benchOptions, err)) {
+                std::cerr << err << "\n";
+                return false;
+            }
+            return true;
+        }
         std::cerr << "Unknown argument: " << arg << "\n";
         return false;
     }
@@ -84,7 +98,7 @@ bool LoadClientConfigFile(const std::string& path,
         return false;
     }
 
-    protocol::JsonObject obj = *root.o;
+    const protocol::JsonObject& obj = *root.o;
     std::string desKeyHex;
     if (!protocol::GetString(obj, "des_key_hex", desKeyHex)) {
         err = "invalid or missing field: des_key_hex";
@@ -123,12 +137,13 @@ bool SendRequest(SOCKET s,
                  const protocol::RequestMessage& req,
                  protocol::ResponseMessage& resp,
                  std::string& err) {
-    std::string reqJson;
-    if (!protocol::EncodeRequest(req, reqJson)) {
+    std::string reqFrame;
+    net::beginFrame(reqFrame);
+    if (!protocol::AppendRequest(req, reqFrame)) {
         err = "EncodeRequest failed";
         return false;
     }
-    if (!net::sendFrame(s, reqJson)) {
+    if (!net::sendFrameBuffer(s, reqFrame)) {
         err = "sendFrame failed";
         return false;
     }
@@ -285,12 +300,12 @@ bool HandleUpload(SOCKET s, const std::string& argsLine) {
             break;
         }
 
-        const std::string b64 = util::Base64Encode(buffer.data(), static_cast<size_t>(got));
+        std::string b64 = util::Base64Encode(buffer.data(), static_cast<size_t>(got));
         protocol::RequestMessage chunkReq;
         chunkReq.cmd = "UPLOAD_CHUNK";
         chunkReq.args.fields["upload_id"] = protocol::MakeString(uploadId);
         chunkReq.args.fields["chunk_index"] = protocol::MakeNumber(static_cast<int64_t>(index));
-        chunkReq.args.fields["data_b64"] = protocol::MakeString(b64);
+        chunkReq.args.fields["data_b64"] = protocol::MakeString(std::move(b64));
 
         protocol::ResponseMessage chunkResp;
         if (!SendRequest(s, chunkReq, chunkResp, err)) {
@@ -342,18 +357,18 @@ bool HandleCheck(SOCKET s) {
         return true;
     }
 
-    protocol::JsonArray files;
-    if (!protocol::GetArray(resp.data, "files", files)) {
+    const protocol::JsonArray* files = protocol::FindArray(resp.data, "files");
+    if (!files) {
         std::cout << "No files field\n";
         return true;
     }
 
     std::cout << "Files:\n";
-    if (files.items.empty()) {
+    if (files->items.empty()) {
         std::cout << "  (empty)\n";
         return true;
     }
-    for (const auto& v : files.items) {
+    for (const auto& v : files->items) {
         if (v.type == protocol::JsonValue::Type::String) {
             std::cout << "  " << v.s << "\n";
         }
@@ -469,9 +484,9 @@ bool HandleDownload(SOCKET s, const std::string& argsLine) {
             return true;
         }
 
-        std::string dataB64;
+        const std::string* dataB64 = protocol::FindString(chunkResp.data, "data_b64");
         bool isLast = false;
-        if (!protocol::GetString(chunkResp.data, "data_b64", dataB64) ||
+        if (!dataB64 ||
             !protocol::GetBool(chunkResp.data, "is_last", isLast)) {
             std::cout << "Download chunk missing fields\n";
             fout.close();
@@ -484,7 +499,7 @@ bool HandleDownload(SOCKET s, const std::string& argsLine) {
         }
 
         std::vector<uint8_t> bytes;
-        if (!util::Base64Decode(dataB64, bytes)) {
+        if (!util::Base64Decode(*dataB64, bytes)) {
             std::cout << "Invalid base64 in chunk\n";
             fout.close();
             std::filesystem::remove(localPath, ec);
@@ -578,6 +593,10 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    if (args.bench) {
+        return client::RunBench(args.benchOptions, config.serverIp, config.desKeyBytes);
+    }
+
     SOCKET s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (s == INVALID_SOCKET) {
         std::cerr << "socket() failed\n";
@@ -730,10 +749,10 @@ int main(int argc, char** argv) {
                   << " | ok=" << (resp.ok ? "true" : "false")
                   << " | code=" << protocol::ErrorCodeToInt(resp.code) << "\n";
 
-        protocol::JsonArray commands;
-        if (protocol::GetArray(resp.data, "commands", commands)) {
+        const protocol::JsonArray* commands = protocol::FindArray(resp.data, "commands");
+        if (commands) {
             std::cout << "Commands:\n";
-            for (const auto& item : commands.items) {
+            for (const auto& item : commands->items) {
                 if (item.type == protocol::JsonValue::Type::String) {
                     std::cout << "  " << item.s << "\n";
                 } else if (item.type == protocol::JsonValue::Type::Object && item.o) {
@@ -2,10 +2,11 @@
 
 #include <algorithm>
 #include <cstring>
-#include <iostream>
 
 #include <winsock2.h>
 
+#include "../utils/Logger.h"
+
 namespace net {
 
 namespace {
@@ -55,7 +56,28 @@ bool sendFrame(SOCKET s, const std::string& payload) {
     return sendAll(s, payload.data(), payload.size());
 }
 
-bool recvFrame(SOCKET s, std::string& payload) {
+void beginFrame(std::string& frame) {
+    frame.assign(kFrameHeaderSize, '\0');
+}
+
+bool finishFrame(std::string& frame) {
+    if (frame.size() < kFrameHeaderSize) {
+        return false;
+    }
+    const uint32_t len = static_cast<uint32_t>(frame.size() - kFrameHeaderSize);
+    const uint32_t lenNet = htonl(len);
+    std::memcpy(&frame[0], &lenNet, sizeof(lenNet));
+    return true;
+}
+
+bool sendFrameBuffer(SOCKET s, std::string& frame) {
+    if (!finishFrame(frame)) {
+        return false;
+    }
+    return sendAll(s, frame.data(), frame.size());
+}
+
+bool recvFrame(SOCKET s, std::string& payload, std::chrono::steady_clock::time_point* headerAt) {
     char peek[4];
     const int peeked = recv(s, peek, static_cast<int>(sizeof(peek)), MSG_PEEK);
     if (peeked > 0 && peek[0] == kBanner[0]) {
@@ -73,9 +95,12 @@ bool recvFrame(SOCKET s, std::string& payload) {
     if (!recvAll(s, &lenNet, sizeof(lenNet))) {
         return false;
     }
+    if (headerAt) {
+        *headerAt = std::chrono::steady_clock::now();
+    }
     const uint32_t len = ntohl(lenNet);
     if (len > kMaxFrameSize) {
-        std::cerr << "recvFrame rejected oversized frame: " << len << " bytes\n";
+        UTIL_LOG(Warn) << "recvFrame rejected oversized frame: " << len << " bytes";
         return false;
     }
 
@@ -84,12 +109,9 @@ bool recvFrame(SOCKET s, std::string& payload) {
         return true;
     }
 
-    std::string buffer(len, '\0');
-    if (!recvAll(s, buffer.data(), buffer.size())) {
-        return false;
-    }
-    payload.swap(buffer);
-    return true;
+    // Reuses the caller's capacity when it is large enough.
+    payload.resize(len);
+    return recvAll(s, payload.data(), payload.size());
 }
 
 } // namespace net
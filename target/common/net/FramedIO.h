@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 
@@ -12,7 +13,20 @@ bool sendAll(SOCKET s, const void* data, size_t len);
 bool recvAll(SOCKET s, void* data, size_t len);
 
 // Length-prefixed frame helpers: [4-byte length][payload]
+// recvFrame() stores the time the length header arrived in `headerAt` when
+// given, so callers can tell payload transfer apart from idle waiting.
 bool sendFrame(SOCKET s, const std::string& payload);
-bool recvFrame(SOCKET s, std::string& payload);
+bool recvFrame(SOCKET s, std::string& payload,
+               std::chrono::steady_clock::time_point* headerAt = nullptr);
+
+// In-place frames: beginFrame() clears `frame` and reserves the 4-byte length
+// header, the caller appends the payload, and sendFrameBuffer() fills in the
+// header and sends header and payload with a single sendAll. Reusing the
+// same string across frames keeps its capacity. finishFrame() only fills in
+// the header, for frames that are built once and sent many times.
+constexpr size_t kFrameHeaderSize = 4;
+void beginFrame(std::string& frame);
+bool finishFrame(std::string& frame);
+bool sendFrameBuffer(SOCKET s, std::string& frame);
 
 } // namespace net
@@ -1,8 +1,12 @@
 #include "JsonLite.h"
 
+#include <algorithm>
 #include <cctype>
+#include <charconv>
 #include <sstream>
 
+#include "JsonScan.h"
+
 namespace protocol {
 
 namespace {
@@ -11,7 +15,7 @@ bool IsWs(char c) {
     return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
-void ConsumeWs(const std::string& s, size_t& i) {
+void ConsumeWs(std::string_view s, size_t& i) {
     while (i < s.size() && IsWs(s[i])) {
         ++i;
     }
@@ -23,35 +27,42 @@ bool ParseString(const std::string& s, size_t& i, std::string& out, size_t maxLe
     }
     ++i;
     std::string result;
-    result.reserve(16);
 
     while (i < s.size()) {
+        // Bulk-copy the run of ordinary characters up to the next special byte.
+        const size_t run = FindJsonSpecial(s.data() + i, s.size() - i);
+        if (result.size() + run > maxLen) {
+            return false;
+        }
+        result.append(s, i, run);
+        i += run;
+        if (i >= s.size()) {
+            break;
+        }
+
         char c = s[i++];
         if (c == '"') {
             out.swap(result);
-            return out.size() <= maxLen;
+            return true;
         }
-        if (c == '\\') {
-            if (i >= s.size()) {
-                return false;
-            }
-            char esc = s[i++];
-            switch (esc) {
-            case '"': result.push_back('"'); break;
-            case '\\': result.push_back('\\'); break;
-            case '/': result.push_back('/'); break;
-            case 'b': result.push_back('\b'); break;
-            case 'f': result.push_back('\f'); break;
-            case 'n': result.push_back('\n'); break;
-            case 'r': result.push_back('\r'); break;
-            case 't': result.push_back('\t'); break;
-            default:
-                return false;
-            }
-        } else if (static_cast<unsigned char>(c) < 0x20) {
+        if (c != '\\') {
+            return false;
+        }
+        if (i >= s.size()) {
+            return false;
+        }
+        char esc = s[i++];
+        switch (esc) {
+        case '"': result.push_back('"'); break;
+        case '\\': result.push_back('\\'); break;
+        case '/': result.push_back('/'); break;
+        case 'b': result.push_back('\b'); break;
+        case 'f': result.push_back('\f'); break;
+        case 'n': result.push_back('\n'); break;
+        case 'r': result.push_back('\r'); break;
+        case 't': result.push_back('\t'); break;
+        default:
             return false;
-        } else {
-            result.push_back(c);
         }
 
         if (result.size() > maxLen) {
@@ -75,13 +86,10 @@ bool ParseNumber(const std::string& s, size_t& i, int64_t& out) {
     if (i < s.size() && (s[i] == '.' || s[i] == 'e' || s[i] == 'E')) {
         return false;
     }
-    const std::string numStr = s.substr(start, i - start);
-    try {
-        out = std::stoll(numStr);
-    } catch (...) {
-        return false;
-    }
-    return true;
+    const char* first = s.data() + start;
+    const char* last = s.data() + i;
+    const auto res = std::from_chars(first, last, out);
+    return res.ec == std::errc() && res.ptr == last;
 }
 
 bool ParseValue(const std::string& s, size_t& i, JsonValue& out, const JsonLimits& limits, size_t depth);
@@ -120,7 +128,7 @@ bool ParseObject(const std::string& s, size_t& i, JsonValue& out, const JsonLimi
         if (!ParseValue(s, i, val, limits, depth + 1)) {
             return false;
         }
-        out.o->fields[key] = val;
+        out.o->fields[key] = std::move(val);
         if (out.o->fields.size() > limits.maxFields) {
             return false;
         }
@@ -235,12 +243,10 @@ bool SerializeObject(const JsonObject& obj, std::string& out) {
             out.push_back(',');
         }
         first = false;
-        std::string escKey;
-        if (!JsonEscape(kv.first, escKey)) {
+        out.push_back('"');
+        if (!JsonEscapeAppend(kv.first, out)) {
             return false;
         }
-        out.push_back('"');
-        out += escKey;
         out += "\":";
         if (!SerializeValue(kv.second, out)) {
             return false;
@@ -273,18 +279,15 @@ bool SerializeValue(const JsonValue& val, std::string& out) {
         out += (val.b ? "true" : "false");
         return true;
     case JsonValue::Type::Number:
-        out += std::to_string(val.n);
+        AppendJsonNumber(val.n, out);
         return true;
-    case JsonValue::Type::String: {
-        std::string esc;
-        if (!JsonEscape(val.s, esc)) {
+    case JsonValue::Type::String:
+        out.push_back('"');
+        if (!JsonEscapeAppend(val.s, out)) {
             return false;
         }
         out.push_back('"');
-        out += esc;
-        out.push_back('"');
         return true;
-    }
     case JsonValue::Type::Object:
         if (!val.o) {
             return false;
@@ -327,6 +330,13 @@ JsonValue MakeString(const std::string& v) {
     return val;
 }
 
+JsonValue MakeString(std::string&& v) {
+    JsonValue val;
+    val.type = JsonValue::Type::String;
+    val.s = std::move(v);
+    return val;
+}
+
 JsonValue MakeObject() {
     JsonValue val;
     val.type = JsonValue::Type::Object;
@@ -341,11 +351,17 @@ JsonValue MakeArray() {
     return val;
 }
 
-bool JsonEscape(const std::string& input, std::string& output) {
-    std::string out;
-    out.reserve(input.size() + 8);
-    for (char c : input) {
-        switch (c) {
+bool JsonEscapeAppend(std::string_view input, std::string& out) {
+    const size_t start = out.size();
+    size_t i = 0;
+    while (i < input.size()) {
+        const size_t run = FindJsonSpecial(input.data() + i, input.size() - i);
+        out.append(input.data() + i, run);
+        i += run;
+        if (i >= input.size()) {
+            break;
+        }
+        switch (input[i++]) {
         case '"': out += "\\\""; break;
         case '\\': out += "\\\\"; break;
         case '\b': out += "\\b"; break;
@@ -354,12 +370,19 @@ bool JsonEscape(const std::string& input, std::string& output) {
         case '\r': out += "\\r"; break;
         case '\t': out += "\\t"; break;
         default:
-            if (static_cast<unsigned char>(c) < 0x20) {
-                return false;
-            }
-            out.push_back(c);
+            out.resize(start);
+            return false;
         }
     }
+    return true;
+}
+
+bool JsonEscape(const std::string& input, std::string& output) {
+    std::string out;
+    out.reserve(input.size() + 8);
+    if (!JsonEscapeAppend(input, out)) {
+        return false;
+    }
     output.swap(out);
     return true;
 }
@@ -411,6 +434,73 @@ bool SerializeJson(const JsonValue& val, std::string& out) {
     return SerializeValue(val, out);
 }
 
+void AppendJsonNumber(int64_t v, std::string& out) {
+    char buf[24];
+    const auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+bool AppendJson(const JsonObject& obj, std::string& out) {
+    return SerializeObject(obj, out);
+}
+
+size_t JsonFields::IndexOf(std::string_view key) const {
+    if (index_.empty()) {
+        for (size_t i = 0; i < items_.size(); ++i) {
+            if (items_[i].first == key) {
+                return i;
+            }
+        }
+        return items_.size();
+    }
+    auto it = std::lower_bound(index_.begin(), index_.end(), key,
+                               [this](uint32_t idx, std::string_view k) { return items_[idx].first < k; });
+    if (it != index_.end() && items_[*it].first == key) {
+        return *it;
+    }
+    return items_.size();
+}
+
+JsonValue& JsonFields::operator[](std::string_view key) {
+    const size_t found = IndexOf(key);
+    if (found < items_.size()) {
+        return items_[found].second;
+    }
+
+    if (items_.empty()) {
+        items_.reserve(kInitialCapacity);
+    }
+    const uint32_t idx = static_cast<uint32_t>(items_.size());
+    items_.emplace_back(std::string(key), JsonValue());
+
+    if (!index_.empty()) {
+        auto pos = std::lower_bound(index_.begin(), index_.end(), key,
+                                    [this](uint32_t i, std::string_view k) { return items_[i].first < k; });
+        index_.insert(pos, idx);
+    } else if (items_.size() > kIndexThreshold) {
+        index_.resize(items_.size());
+        for (uint32_t i = 0; i < index_.size(); ++i) {
+            index_[i] = i;
+        }
+        std::sort(index_.begin(), index_.end(),
+                  [this](uint32_t a, uint32_t b) { return items_[a].first < items_[b].first; });
+    }
+    return items_.back().second;
+}
+
+JsonFields::iterator JsonFields::find(std::string_view key) {
+    return items_.begin() + IndexOf(key);
+}
+
+JsonFields::const_iterator JsonFields::find(std::string_view key) const {
+    return items_.begin() + IndexOf(key);
+}
+
+void JsonFields::clear() {
+    items_.clear();
+    index_.clear();
+}
+
 bool GetString(const JsonObject& obj, const std::string& key, std::string& out) {
     auto it = obj.fields.find(key);
     if (it == obj.fields.end() || it->second.type != JsonValue::Type::String) {
@@ -456,4 +546,28 @@ bool GetArray(const JsonObject& obj, const std::string& key, JsonArray& out) {
     return true;
 }
 
+const std::string* FindString(const JsonObject& obj, std::string_view key) {
+    auto it = obj.fields.find(key);
+    if (it == obj.fields.end() || it->second.type != JsonValue::Type::String) {
+        return nullptr;
+    }
+    return &it->second.s;
+}
+
+const JsonObject* FindObject(const JsonObject& obj, std::string_view key) {
+    auto it = obj.fields.find(key);
+    if (it == obj.fields.end() || it->second.type != JsonValue::Type::Object) {
+        return nullptr;
+    }
+    return it->second.o.get();
+}
+
+const JsonArray* FindArray(const JsonObject& obj, std::string_view key) {
+    auto it = obj.fields.find(key);
+    if (it == obj.fields.end() || it->second.type != JsonValue::Type::Array) {
+        return nullptr;
+    }
+    return it->second.a.get();
+}
+
 } // namespace protocol
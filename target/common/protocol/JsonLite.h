@@ -3,7 +3,8 @@
 #include <cstdint>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace protocol {
@@ -29,8 +30,43 @@ struct JsonValue {
     std::shared_ptr<JsonArray> a;
 };
 
+// Object members in insertion order, so serialization is deterministic.
+// Lookups scan linearly; objects that grow past kIndexThreshold members also
+// keep a key-sorted index for binary search. operator[] replaces the value of
+// an existing key in place, like std::map.
+class JsonFields {
+public:
+    using value_type = std::pair<std::string, JsonValue>;
+    using iterator = std::vector<value_type>::iterator;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    static constexpr size_t kInitialCapacity = 4;
+    static constexpr size_t kIndexThreshold = 16;
+
+    JsonValue& operator[](std::string_view key);
+
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+
+    iterator begin() { return items_.begin(); }
+    iterator end() { return items_.end(); }
+    const_iterator begin() const { return items_.begin(); }
+    const_iterator end() const { return items_.end(); }
+
+    size_t size() const { return items_.size(); }
+    bool empty() const { return items_.empty(); }
+    void reserve(size_t n) { items_.reserve(n); }
+    void clear();
+
+private:
+    size_t IndexOf(std::string_view key) const;
+
+    std::vector<value_type> items_;
+    std::vector<uint32_t> index_;
+};
+
 struct JsonObject {
-    std::unordered_map<std::string, JsonValue> fields;
+    JsonFields fields;
 };
 
 struct JsonArray {
@@ -49,14 +85,22 @@ JsonValue MakeNull();
 JsonValue MakeBool(bool v);
 JsonValue MakeNumber(int64_t v);
 JsonValue MakeString(const std::string& v);
+JsonValue MakeString(std::string&& v);
 JsonValue MakeObject();
 JsonValue MakeArray();
 
 bool JsonEscape(const std::string& input, std::string& output);
+// Appends the escaped form of `input` to `out`; on failure `out` is left as it
+// was.
+bool JsonEscapeAppend(std::string_view input, std::string& out);
 bool JsonUnescape(const std::string& input, std::string& output);
 
 bool ParseJson(const std::string& json, JsonValue& out, const JsonLimits& limits);
 bool SerializeJson(const JsonValue& val, std::string& out);
+// Appends `obj` to `out` without clearing it, so callers can serialize a
+// borrowed object into a larger document.
+bool AppendJson(const JsonObject& obj, std::string& out);
+void AppendJsonNumber(int64_t v, std::string& out);
 
 bool GetString(const JsonObject& obj, const std::string& key, std::string& out);
 bool GetNumber(const JsonObject& obj, const std::string& key, int64_t& out);
@@ -64,4 +108,10 @@ bool GetBool(const JsonObject& obj, const std::string& key, bool& out);
 bool GetObject(const JsonObject& obj, const std::string& key, JsonObject& out);
 bool GetArray(const JsonObject& obj, const std::string& key, JsonArray& out);
 
+// Borrowing lookups: nullptr when the key is missing or holds another type.
+// The result stays valid until `obj` is modified.
+const std::string* FindString(const JsonObject& obj, std::string_view key);
+const JsonObject* FindObject(const JsonObject& obj, std::string_view key);
+const JsonArray* FindArray(const JsonObject& obj, std::string_view key);
+
 } // namespace protocol
@@ -0,0 +1,130 @@
+#include "JsonScan.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "../utils/CpuFeatures.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CS_JSON_SSE2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define CS_TARGET(x) __attribute__((target(x)))
+#else
+#define CS_TARGET(x)
+#endif
+
+namespace protocol {
+
+namespace {
+
+inline bool IsSpecial(unsigned char c) {
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+inline unsigned LowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long idx = 0;
+    _BitScanForward(&idx, mask);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+size_t FindPortable(const char* p, size_t n) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        const uint64_t quote = w ^ (ones * '"');
+        const uint64_t slash = w ^ (ones * '\\');
+        // Classic "has zero byte" / "has byte less than 0x20" tests.
+        const uint64_t hit = ((quote - ones) & ~quote) |
+                             ((slash - ones) & ~slash) |
+                             ((w - ones * 0x20) & ~w);
+        if ((hit & highs) != 0) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (IsSpecial(static_cast<unsigned char>(p[i]))) {
+            return i;
+        }
+    }
+    return n;
+}
+
+#if defined(CS_JSON_SSE2)
+
+size_t FindSse2(const char* p, size_t n) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i ctl = _mm_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, ctl), v));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hit));
+        if (mask != 0) {
+            return i + LowestBit(mask);
+        }
+    }
+    return i + FindPortable(p + i, n - i);
+}
+
+CS_TARGET("avx2")
+size_t FindAvx2(const char* p, size_t n) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i slash = _mm256_set1_epi8('\\');
+    const __m256i ctl = _mm256_set1_epi8(0x1F);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i hit = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, slash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(v, ctl), v));
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if (mask != 0) {
+            return i + LowestBit(mask);
+        }
+    }
+    return i + FindSse2(p + i, n - i);
+}
+
+using FindFn = size_t (*)(const char*, size_t);
+
+FindFn SelectFind() {
+    if (static_cast<int>(util::DetectSimdLevel()) >= static_cast<int>(util::SimdLevel::Avx2)) {
+        return FindAvx2;
+    }
+    if (util::DetectSimdLevel() == util::SimdLevel::Scalar) {
+        return FindPortable;
+    }
+    return FindSse2;
+}
+
+#endif
+
+} // namespace
+
+size_t FindJsonSpecial(const char* p, size_t n) {
+#if defined(CS_JSON_SSE2)
+    static const FindFn kFind = SelectFind();
+    return kFind(p, n);
+#else
+    return FindPortable(p, n);
+#endif
+}
+
+} // namespace protocol
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+namespace protocol {
+
+// Returns the offset of the first byte in [p, p + n) that needs attention in a
+// JSON string ('"', '\\' or a control character < 0x20), or n if there is none.
+// Scans 32 bytes at a time with AVX2 when available, 16 with SSE2, and 8 with
+// a portable word-at-a-time fallback.
+size_t FindJsonSpecial(const char* p, size_t n);
+
+} // namespace protocol
@@ -0,0 +1,422 @@
+#include "JsonView.h"
+
+#include <charconv>
+#include <cstring>
+
+#include "JsonScan.h"
+
+namespace protocol {
+
+namespace {
+
+bool IsWs(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+JsonView::Type JsonView::type() const {
+    return node_ ? node_->type : Type::Null;
+}
+
+bool JsonView::asBool() const {
+    return node_ && node_->type == Type::Bool ? node_->b : false;
+}
+
+int64_t JsonView::asNumber() const {
+    return node_ && node_->type == Type::Number ? node_->n : 0;
+}
+
+std::string_view JsonView::asString() const {
+    if (!node_ || node_->type != Type::String) {
+        return std::string_view();
+    }
+    return std::string_view(node_->str, node_->len);
+}
+
+size_t JsonView::size() const {
+    if (!node_ || (node_->type != Type::Object && node_->type != Type::Array)) {
+        return 0;
+    }
+    return node_->len;
+}
+
+std::string_view JsonView::keyAt(size_t i) const {
+    const Node& key = node_->kids[2 * i];
+    return std::string_view(key.str, key.len);
+}
+
+JsonView JsonView::valueAt(size_t i) const {
+    return JsonView(&node_->kids[2 * i + 1]);
+}
+
+JsonView JsonView::at(size_t i) const {
+    return JsonView(&node_->kids[i]);
+}
+
+JsonView JsonView::find(std::string_view key) const {
+    if (!node_ || node_->type != Type::Object) {
+        return JsonView();
+    }
+    for (size_t i = node_->len; i > 0; --i) {
+        const Node& k = node_->kids[2 * (i - 1)];
+        if (std::string_view(k.str, k.len) == key) {
+            return JsonView(&k + 1);
+        }
+    }
+    return JsonView();
+}
+
+bool JsonDocument::Parse(std::string_view json, const JsonLimits& limits) {
+    src_ = json;
+    pos_ = 0;
+    limits_ = &limits;
+    root_ = Node{};
+    arena_.Reset();
+    stack_.clear();
+    if (json.size() > limits.maxJsonSize) {
+        return false;
+    }
+    if (!ParseValue(root_, 0)) {
+        return false;
+    }
+    SkipWs();
+    return pos_ == src_.size();
+}
+
+void JsonDocument::SkipWs() {
+    while (pos_ < src_.size() && IsWs(src_[pos_])) {
+        ++pos_;
+    }
+}
+
+bool JsonDocument::ParseString(Node& out) {
+    if (pos_ >= src_.size() || src_[pos_] != '"') {
+        return false;
+    }
+    out.type = JsonView::Type::String;
+    const size_t start = ++pos_;
+    pos_ += FindJsonSpecial(src_.data() + pos_, src_.size() - pos_);
+    if (pos_ >= src_.size()) {
+        return false;
+    }
+    if (src_[pos_] == '"') {
+        const size_t len = pos_ - start;
+        ++pos_;
+        out.str = src_.data() + start;
+        out.len = static_cast<uint32_t>(len);
+        return len <= limits_->maxStringSize;
+    }
+    if (src_[pos_] != '\\') {
+        return false;
+    }
+
+    // Escapes present: copy the clean prefix, then unescape the rest.
+    scratch_.assign(src_.data() + start, pos_ - start);
+    while (pos_ < src_.size()) {
+        const size_t run = FindJsonSpecial(src_.data() + pos_, src_.size() - pos_);
+        scratch_.append(src_.data() + pos_, run);
+        pos_ += run;
+        if (pos_ >= src_.size() || scratch_.size() > limits_->maxStringSize) {
+            return false;
+        }
+        const char c = src_[pos_++];
+        if (c == '"') {
+            char* copy = arena_.AllocateArray<char>(scratch_.size());
+            std::memcpy(copy, scratch_.data(), scratch_.size());
+            out.str = copy;
+            out.len = static_cast<uint32_t>(scratch_.size());
+            return true;
+        }
+        if (c != '\\' || pos_ >= src_.size()) {
+            return false;
+        }
+        const char esc = src_[pos_++];
+        switch (esc) {
+        case '"': scratch_.push_back('"'); break;
+        case '\\': scratch_.push_back('\\'); break;
+        case '/': scratch_.push_back('/'); break;
+        case 'b': scratch_.push_back('\b'); break;
+        case 'f': scratch_.push_back('\f'); break;
+        case 'n': scratch_.push_back('\n'); break;
+        case 'r': scratch_.push_back('\r'); break;
+        case 't': scratch_.push_back('\t'); break;
+        default:
+            return false;
+        }
+        if (scratch_.size() > limits_->maxStringSize) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool JsonDocument::ParseNumber(int64_t& out) {
+    const size_t start = pos_;
+    if (pos_ < src_.size() && src_[pos_] == '-') {
+        ++pos_;
+    }
+    if (pos_ >= src_.size() || src_[pos_] < '0' || src_[pos_] > '9') {
+        return false;
+    }
+    while (pos_ < src_.size() && src_[pos_] >= '0' && src_[pos_] <= '9') {
+        ++pos_;
+    }
+    if (pos_ < src_.size() && (src_[pos_] == '.' || src_[pos_] == 'e' || src_[pos_] == 'E')) {
+        return false;
+    }
+    const char* first = src_.data() + start;
+    const char* last = src_.data() + pos_;
+    const auto res = std::from_chars(first, last, out);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+// Children are parsed onto stack_ (nested containers pop their own children
+// before returning), then moved into one contiguous arena run.
+bool JsonDocument::CloseContainer(Node& out, size_t base, uint32_t count) {
+    const size_t n = stack_.size() - base;
+    Node* kids = nullptr;
+    if (n > 0) {
+        kids = arena_.AllocateArray<Node>(n);
+        std::memcpy(kids, stack_.data() + base, n * sizeof(Node));
+        stack_.resize(base);
+    }
+    out.kids = kids;
+    out.len = count;
+    return true;
+}
+
+bool JsonDocument::ParseObject(Node& out, size_t depth) {
+    if (depth > limits_->maxDepth) {
+        return false;
+    }
+    ++pos_;
+    SkipWs();
+    out.type = JsonView::Type::Object;
+    const size_t base = stack_.size();
+    uint32_t count = 0;
+
+    if (pos_ < src_.size() && src_[pos_] == '}') {
+        ++pos_;
+        return CloseContainer(out, base, 0);
+    }
+
+    while (pos_ < src_.size()) {
+        SkipWs();
+        Node key{};
+        if (!ParseString(key)) {
+            return false;
+        }
+        SkipWs();
+        if (pos_ >= src_.size() || src_[pos_] != ':') {
+            return false;
+        }
+        ++pos_;
+        SkipWs();
+
+        Node value{};
+        if (!ParseValue(value, depth + 1)) {
+            return false;
+        }
+        if (++count > limits_->maxFields) {
+            return false;
+        }
+        stack_.push_back(key);
+        stack_.push_back(value);
+
+        SkipWs();
+        if (pos_ >= src_.size()) {
+            return false;
+        }
+        if (src_[pos_] == ',') {
+            ++pos_;
+            continue;
+        }
+        if (src_[pos_] == '}') {
+            ++pos_;
+            return CloseContainer(out, base, count);
+        }
+        return false;
+    }
+    return false;
+}
+
+bool JsonDocument::ParseArray(Node& out, size_t depth) {
+    if (depth > limits_->maxDepth) {
+        return false;
+    }
+    ++pos_;
+    SkipWs();
+    out.type = JsonView::Type::Array;
+    const size_t base = stack_.size();
+    uint32_t count = 0;
+
+    if (pos_ < src_.size() && src_[pos_] == ']') {
+        ++pos_;
+        return CloseContainer(out, base, 0);
+    }
+
+    while (pos_ < src_.size()) {
+        Node item{};
+        if (!ParseValue(item, depth + 1)) {
+            return false;
+        }
+        if (++count > limits_->maxArraySize) {
+            return false;
+        }
+        stack_.push_back(item);
+
+        SkipWs();
+        if (pos_ >= src_.size()) {
+            return false;
+        }
+        if (src_[pos_] == ',') {
+            ++pos_;
+            SkipWs();
+            continue;
+        }
+        if (src_[pos_] == ']') {
+            ++pos_;
+            return CloseContainer(out, base, count);
+        }
+        return false;
+    }
+    return false;
+}
+
+bool JsonDocument::ParseValue(Node& out, size_t depth) {
+    SkipWs();
+    if (pos_ >= src_.size()) {
+        return false;
+    }
+
+    const char c = src_[pos_];
+    if (c == '"') {
+        return ParseString(out);
+    }
+    if (c == '{') {
+        return ParseObject(out, depth);
+    }
+    if (c == '[') {
+        return ParseArray(out, depth);
+    }
+    const std::string_view rest = src_.substr(pos_);
+    if (rest.compare(0, 4, "true") == 0) {
+        pos_ += 4;
+        out.type = JsonView::Type::Bool;
+        out.b = true;
+        return true;
+    }
+    if (rest.compare(0, 5, "false") == 0) {
+        pos_ += 5;
+        out.type = JsonView::Type::Bool;
+        out.b = false;
+        return true;
+    }
+    if (rest.compare(0, 4, "null") == 0) {
+        pos_ += 4;
+        out.type = JsonView::Type::Null;
+        return true;
+    }
+
+    out.type = JsonView::Type::Number;
+    return ParseNumber(out.n);
+}
+
+bool GetString(JsonView obj, std::string_view key, std::string_view& out) {
+    const JsonView v = obj.find(key);
+    if (v.type() != JsonView::Type::String) {
+        return false;
+    }
+    out = v.asString();
+    return true;
+}
+
+bool GetString(JsonView obj, std::string_view key, std::string& out) {
+    std::string_view v;
+    if (!GetString(obj, key, v)) {
+        return false;
+    }
+    out.assign(v.data(), v.size());
+    return true;
+}
+
+bool GetNumber(JsonView obj, std::string_view key, int64_t& out) {
+    const JsonView v = obj.find(key);
+    if (v.type() != JsonView::Type::Number) {
+        return false;
+    }
+    out = v.asNumber();
+    return true;
+}
+
+bool GetBool(JsonView obj, std::string_view key, bool& out) {
+    const JsonView v = obj.find(key);
+    if (v.type() != JsonView::Type::Bool) {
+        return false;
+    }
+    out = v.asBool();
+    return true;
+}
+
+bool GetObject(JsonView obj, std::string_view key, JsonView& out) {
+    const JsonView v = obj.find(key);
+    if (!v.isObject()) {
+        return false;
+    }
+    out = v;
+    return true;
+}
+
+bool GetArray(JsonView obj, std::string_view key, JsonView& out) {
+    const JsonView v = obj.find(key);
+    if (!v.isArray()) {
+        return false;
+    }
+    out = v;
+    return true;
+}
+
+JsonValue ToJsonValue(JsonView v) {
+    switch (v.type()) {
+    case JsonView::Type::Bool:
+        return MakeBool(v.asBool());
+    case JsonView::Type::Number:
+        return MakeNumber(v.asNumber());
+    case JsonView::Type::String: {
+        JsonValue val;
+        val.type = JsonValue::Type::String;
+        val.s.assign(v.asString().data(), v.asString().size());
+        return val;
+    }
+    case JsonView::Type::Object: {
+        JsonValue val = MakeObject();
+        ToJsonObject(v, *val.o);
+        return val;
+    }
+    case JsonView::Type::Array: {
+        JsonValue val = MakeArray();
+        val.a->items.reserve(v.size());
+        for (size_t i = 0; i < v.size(); ++i) {
+            val.a->items.push_back(ToJsonValue(v.at(i)));
+        }
+        return val;
+    }
+    default:
+        return MakeNull();
+    }
+}
+
+bool ToJsonObject(JsonView v, JsonObject& out) {
+    if (!v.isObject()) {
+        return false;
+    }
+    out.fields.clear();
+    out.fields.reserve(v.size());
+    for (size_t i = 0; i < v.size(); ++i) {
+        out.fields[std::string(v.keyAt(i))] = ToJsonValue(v.valueAt(i));
+    }
+    return true;
+}
+
+} // namespace protocol
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JsonLite.h"
+#include "../utils/Arena.h"
+
+namespace protocol {
+
+// Read-only parse mode: strings and keys are std::string_views into the source
+// buffer (which must outlive the document); only strings that contain escapes
+// are copied. Numbers are parsed with std::from_chars. JsonLimits apply as in
+// ParseJson.
+//
+// Nodes are 16 bytes and live in the document's arena, so a reused document
+// parses without heap allocation and frees the previous tree in one step.
+class JsonDocument;
+
+class JsonView {
+public:
+    using Type = JsonValue::Type;
+
+    JsonView() = default;
+
+    bool valid() const { return node_ != nullptr; }
+    Type type() const;
+    bool isObject() const { return type() == Type::Object; }
+    bool isArray() const { return type() == Type::Array; }
+
+    bool asBool() const;
+    int64_t asNumber() const;
+    std::string_view asString() const;
+
+    // Objects: members in source order. Arrays: items.
+    size_t size() const;
+    std::string_view keyAt(size_t i) const;
+    JsonView valueAt(size_t i) const;
+    JsonView at(size_t i) const;
+
+    // Last member with this key, or an invalid view.
+    JsonView find(std::string_view key) const;
+
+private:
+    friend class JsonDocument;
+
+    struct Node;
+    explicit JsonView(const Node* node) : node_(node) {}
+
+    const Node* node_ = nullptr;
+};
+
+// Object children are stored as alternating key/value nodes; array children as
+// consecutive items. `len` counts members or items, or bytes for strings.
+struct JsonView::Node {
+    Type type;
+    uint32_t len;
+    union {
+        bool b;
+        int64_t n;
+        const char* str;
+        const Node* kids;
+    };
+};
+
+class JsonDocument {
+public:
+    bool Parse(std::string_view json, const JsonLimits& limits);
+    JsonView root() const { return JsonView(&root_); }
+
+    size_t arenaBytes() const { return arena_.bytesUsed(); }
+
+private:
+    using Node = JsonView::Node;
+    static_assert(sizeof(Node) <= 16, "JsonView::Node should stay compact");
+
+    bool ParseValue(Node& out, size_t depth);
+    bool ParseObject(Node& out, size_t depth);
+    bool ParseArray(Node& out, size_t depth);
+    bool ParseString(Node& out);
+    bool CloseContainer(Node& out, size_t base, uint32_t count);
+    bool ParseNumber(int64_t& out);
+    void SkipWs();
+
+    std::string_view src_;
+    size_t pos_ = 0;
+    const JsonLimits* limits_ = nullptr;
+    Node root_{};
+    util::Arena arena_;
+    std::vector<Node> stack_;
+    std::string scratch_;
+};
+
+bool GetString(JsonView obj, std::string_view key, std::string_view& out);
+// Copies the value, for callers that keep it beyond the document.
+bool GetString(JsonView obj, std::string_view key, std::string& out);
+bool GetNumber(JsonView obj, std::string_view key, int64_t& out);
+bool GetBool(JsonView obj, std::string_view key, bool& out);
+bool GetObject(JsonView obj, std::string_view key, JsonView& out);
+bool GetArray(JsonView obj, std::string_view key, JsonView& out);
+
+// Copies a view into the owning DOM.
+JsonValue ToJsonValue(JsonView v);
+bool ToJsonObject(JsonView v, JsonObject& out);
+
+} // namespace protocol
@@ -1,106 +1,124 @@
 #include "Message.h"
 
+#include <utility>
+
 namespace protocol {
 
 namespace {
 
 const JsonLimits kLimits{};
 
-bool GetTypeObject(const JsonValue& root, JsonObject& obj) {
-    if (root.type != JsonValue::Type::Object || !root.o) {
-        return false;
-    }
-    obj = *root.o;
-    return true;
+// BATCH responses carry each sub-response two levels deeper
+// (data.results[i].data), so responses are parsed with that much extra depth.
+// Requests keep the default limits; batch sub-requests use flat args.
+const size_t kBatchExtraDepth = 2;
+
+JsonLimits MakeResponseLimits() {
+    JsonLimits limits;
+    limits.maxDepth += kBatchExtraDepth;
+    return limits;
 }
 
-JsonValue MakeObjectFrom(const JsonObject& obj) {
-    JsonValue v = MakeObject();
-    if (v.o) {
-        v.o->fields = obj.fields;
+const JsonLimits kResponseLimits = MakeResponseLimits();
+
+bool AppendStringMember(std::string& out, const char* key, const std::string& value) {
+    out += '"';
+    out += key;
+    out += "\":\"";
+    if (!JsonEscapeAppend(value, out)) {
+        return false;
     }
-    return v;
+    out += '"';
+    return true;
 }
 
 } // namespace
 
-bool EncodeRequest(const RequestMessage& req, std::string& outJson) {
-    JsonObject root;
-    root.fields["type"] = MakeString("CMD");
-    root.fields["cmd"] = MakeString(req.cmd);
-    root.fields["args"] = MakeObjectFrom(req.args);
-
-    JsonValue top = MakeObjectFrom(root);
-    if (!SerializeJson(top, outJson)) {
+// The envelopes are written directly so the borrowed args/data objects are
+// serialized in place rather than copied into a temporary root object.
+bool AppendRequest(const RequestMessage& req, std::string& out) {
+    const size_t start = out.size();
+    out += "{\"type\":\"CMD\",";
+    if (!AppendStringMember(out, "cmd", req.cmd)) {
         return false;
     }
-    return outJson.size() <= kLimits.maxJsonSize;
-}
-
-bool EncodeResponse(const ResponseMessage& resp, std::string& outJson) {
-    JsonObject root;
-    root.fields["type"] = MakeString("RSP");
-    root.fields["ok"] = MakeBool(resp.ok);
-    root.fields["code"] = MakeNumber(ErrorCodeToInt(resp.code));
-    root.fields["msg"] = MakeString(resp.msg);
-    root.fields["data"] = MakeObjectFrom(resp.data);
-
-    JsonValue top = MakeObjectFrom(root);
-    if (!SerializeJson(top, outJson)) {
+    out += ",\"args\":";
+    if (!AppendJson(req.args, out)) {
         return false;
     }
-    return outJson.size() <= kLimits.maxJsonSize;
+    out += '}';
+    return out.size() - start <= kLimits.maxJsonSize;
 }
 
-bool DecodeRequest(const std::string& json, RequestMessage& outReq, ErrorCode& outErr) {
-    JsonValue root;
-    if (!ParseJson(json, root, kLimits)) {
-        outErr = ErrorCode::BadRequest;
+bool AppendResponse(const ResponseMessage& resp, std::string& out) {
+    const size_t start = out.size();
+    out += "{\"type\":\"RSP\",\"ok\":";
+    out += resp.ok ? "true" : "false";
+    out += ",\"code\":";
+    AppendJsonNumber(ErrorCodeToInt(resp.code), out);
+    out += ',';
+    if (!AppendStringMember(out, "msg", resp.msg)) {
+        return false;
+    }
+    out += ",\"data\":";
+    if (!AppendJson(resp.data, out)) {
         return false;
     }
+    out += '}';
+    return out.size() - start <= kLimits.maxJsonSize;
+}
+
+bool EncodeRequest(const RequestMessage& req, std::string& outJson) {
+    outJson.clear();
+    return AppendRequest(req, outJson);
+}
 
-    JsonObject obj;
-    if (!GetTypeObject(root, obj)) {
+bool EncodeResponse(const ResponseMessage& resp, std::string& outJson) {
+    outJson.clear();
+    return AppendResponse(resp, outJson);
+}
+
+bool DecodeRequest(const std::string& json, JsonDocument& doc, RequestMessage& outReq, ErrorCode& outErr) {
+    if (!doc.Parse(json, kLimits) || !doc.root().isObject()) {
         outErr = ErrorCode::BadRequest;
         return false;
     }
+    const JsonView root = doc.root();
 
-    std::string type;
-    if (!GetString(obj, "type", type) || type != "CMD") {
+    std::string_view type;
+    if (!GetString(root, "type", type) || type != "CMD") {
         outErr = ErrorCode::BadRequest;
         return false;
     }
 
-    if (!GetString(obj, "cmd", outReq.cmd)) {
+    std::string_view cmd;
+    if (!GetString(root, "cmd", cmd)) {
         outErr = ErrorCode::BadRequest;
         return false;
     }
 
-    JsonObject args;
-    if (!GetObject(obj, "args", args)) {
+    JsonView args;
+    if (!GetObject(root, "args", args)) {
         outErr = ErrorCode::BadRequest;
         return false;
     }
-    outReq.args = args;
+    outReq.cmd.assign(cmd.data(), cmd.size());
+    outReq.args.fields.clear();
+    outReq.argsView = args;
     outErr = ErrorCode::Ok;
     return true;
 }
 
 bool DecodeResponse(const std::string& json, ResponseMessage& outResp, ErrorCode& outErr) {
     JsonValue root;
-    if (!ParseJson(json, root, kLimits)) {
-        outErr = ErrorCode::BadRequest;
-        return false;
-    }
-
-    JsonObject obj;
-    if (!GetTypeObject(root, obj)) {
+    if (!ParseJson(json, root, kResponseLimits) || root.type != JsonValue::Type::Object || !root.o) {
         outErr = ErrorCode::BadRequest;
         return false;
     }
+    JsonObject& obj = *root.o;
 
-    std::string type;
-    if (!GetString(obj, "type", type) || type != "RSP") {
+    const std::string* type = FindString(obj, "type");
+    if (!type || *type != "RSP") {
         outErr = ErrorCode::BadRequest;
         return false;
     }
@@ -117,22 +135,23 @@ bool DecodeResponse(const std::string& json, ResponseMessage& outResp, ErrorCode
         return false;
     }
 
-    std::string msg;
-    if (!GetString(obj, "msg", msg)) {
+    auto msg = obj.fields.find("msg");
+    if (msg == obj.fields.end() || msg->second.type != JsonValue::Type::String) {
         outErr = ErrorCode::BadRequest;
         return false;
     }
 
-    JsonObject data;
-    if (!GetObject(obj, "data", data)) {
+    auto data = obj.fields.find("data");
+    if (data == obj.fields.end() || data->second.type != JsonValue::Type::Object || !data->second.o) {
         outErr = ErrorCode::BadRequest;
         return false;
     }
 
+    // `root` is ours, so the payload is moved out rather than copied.
     outResp.ok = ok;
     outResp.code = ErrorCodeFromInt(static_cast<int>(codeVal));
-    outResp.msg = msg;
-    outResp.data = data;
+    outResp.msg = std::move(msg->second.s);
+    outResp.data = std::move(*data->second.o);
     outErr = ErrorCode::Ok;
     return true;
 }
@@ -1,15 +1,24 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 #include "ErrorCode.h"
 #include "JsonLite.h"
+#include "JsonView.h"
 
 namespace protocol {
 
 struct RequestMessage {
     std::string cmd;
+    // Arguments of a request being built; EncodeRequest serializes these.
     JsonObject args;
+    // Arguments of a decoded request. DecodeRequest leaves `args` empty and
+    // points this at the args object in its JsonDocument, so handlers read
+    // them without building an owning DOM. Unescaped strings view the frame
+    // itself, so large payloads such as UPLOAD_CHUNK's data_b64 are never
+    // copied. Valid while that document and the frame it parsed live.
+    JsonView argsView;
 };
 
 struct ResponseMessage {
@@ -21,8 +30,15 @@ struct ResponseMessage {
 
 bool EncodeRequest(const RequestMessage& req, std::string& outJson);
 bool EncodeResponse(const ResponseMessage& resp, std::string& outJson);
+// Append variants leave existing contents (e.g. a reserved frame header) in
+// place; the size limit applies to the appended JSON only.
+bool AppendRequest(const RequestMessage& req, std::string& out);
+bool AppendResponse(const ResponseMessage& resp, std::string& out);
+
+// Parses into `doc`, which the caller keeps (and reuses) for as long as
+// `outReq.argsView` is read.
+bool DecodeRequest(const std::string& json, JsonDocument& doc, RequestMessage& outReq, ErrorCode& outErr);
 
-bool DecodeRequest(const std::string& json, RequestMessage& outReq, ErrorCode& outErr);
 bool DecodeResponse(const std::string& json, ResponseMessage& outResp, ErrorCode& outErr);
 
 } // namespace protocol
@@ -0,0 +1,34 @@
+#include "Arena.h"
+
+#include <algorithm>
+
+namespace util {
+
+void* Arena::AllocateSlow(size_t size, size_t align) {
+    const size_t need = size + align;
+    Block block;
+    block.size = std::max(blockSize_, need);
+    block.data.reset(new char[block.size]);
+    blocks_.push_back(std::move(block));
+
+    cur_ = blocks_.back().data.get();
+    end_ = cur_ + blocks_.back().size;
+    return Allocate(size, align);
+}
+
+void Arena::Reset() {
+    if (blocks_.empty()) {
+        return;
+    }
+    // Keep the largest block so steady-state requests fit in one.
+    auto largest = std::max_element(blocks_.begin(), blocks_.end(),
+                                    [](const Block& a, const Block& b) { return a.size < b.size; });
+    Block keep = std::move(*largest);
+    blocks_.clear();
+    blocks_.push_back(std::move(keep));
+    cur_ = blocks_.back().data.get();
+    end_ = cur_ + blocks_.back().size;
+    used_ = 0;
+}
+
+} // namespace util
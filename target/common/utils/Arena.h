@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace util {
+
+// Bump allocator for short-lived, trivially destructible data. Allocate()
+// never frees individually; Reset() releases everything at once but keeps the
+// largest block so a reused arena stops touching the heap once it has warmed
+// up.
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 4096) : blockSize_(blockSize) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void Reset();
+
+    size_t bytesUsed() const { return used_; }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    void* AllocateSlow(size_t size, size_t align);
+
+    size_t blockSize_;
+    std::vector<Block> blocks_;
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    size_t used_ = 0;
+};
+
+inline void* Arena::Allocate(size_t size, size_t align) {
+    char* p = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(cur_) + (align - 1)) & ~static_cast<uintptr_t>(align - 1));
+    if (cur_ == nullptr || p + size > end_) {
+        return AllocateSlow(size, align);
+    }
+    cur_ = p + size;
+    used_ += size;
+    return p;
+}
+
+} // namespace util
@@ -1,7 +1,9 @@
 #include "Base64.h"
 
 #include <array>
-#include <cctype>
+
+#include "Base64Simd.h"
+#include "CpuFeatures.h"
 
 namespace util {
 
@@ -12,49 +14,112 @@ const char kAlphabet[] =
     "abcdefghijklmnopqrstuvwxyz"
     "0123456789+/";
 
-std::array<int, 256> BuildDecodeTable() {
-    std::array<int, 256> table;
-    table.fill(-1);
+const int8_t kInvalid = -1;
+const int8_t kSpace = -2;
+const int8_t kPad = -3;
+
+// Replaces the per-byte std::isspace call: whitespace and '=' get their own
+// markers in the same table as the alphabet.
+std::array<int8_t, 256> BuildDecodeTable() {
+    std::array<int8_t, 256> table;
+    table.fill(kInvalid);
     for (int i = 0; i < 64; ++i) {
-        table[static_cast<unsigned char>(kAlphabet[i])] = i;
+        table[static_cast<unsigned char>(kAlphabet[i])] = static_cast<int8_t>(i);
+    }
+    for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        table[c] = kSpace;
     }
+    table[static_cast<unsigned char>('=')] = kPad;
     return table;
 }
 
-} // namespace
+using EncodeKernel = size_t (*)(const uint8_t*, size_t, char*);
+using DecodeKernel = size_t (*)(const char*, size_t, uint8_t*);
+
+struct Kernels {
+    EncodeKernel encode = nullptr;
+    DecodeKernel decode = nullptr;
+};
+
+Kernels SelectKernels() {
+    Kernels k;
+#if defined(CS_BASE64_X86)
+    switch (DetectSimdLevel()) {
+    case SimdLevel::Avx512Vbmi:
+        k.encode = simd::EncodeAvx512Vbmi;
+        k.decode = simd::DecodeAvx512Vbmi;
+        break;
+    case SimdLevel::Avx2:
+        k.encode = simd::EncodeAvx2;
+        k.decode = simd::DecodeAvx2;
+        break;
+    case SimdLevel::Sse41:
+        k.encode = simd::EncodeSse41;
+        k.decode = simd::DecodeSse41;
+        break;
+    default:
+        break;
+    }
+#endif
+    return k;
+}
 
-std::string Base64Encode(const uint8_t* data, size_t len) {
-    std::string out;
-    out.reserve(((len + 2) / 3) * 4);
+const Kernels& ActiveKernels() {
+    static const Kernels kernels = SelectKernels();
+    return kernels;
+}
 
+void EncodeScalar(const uint8_t* data, size_t len, char* out) {
     size_t i = 0;
     while (i + 2 < len) {
         const uint32_t n = (static_cast<uint32_t>(data[i]) << 16) |
                            (static_cast<uint32_t>(data[i + 1]) << 8) |
                            static_cast<uint32_t>(data[i + 2]);
-        out.push_back(kAlphabet[(n >> 18) & 0x3F]);
-        out.push_back(kAlphabet[(n >> 12) & 0x3F]);
-        out.push_back(kAlphabet[(n >> 6) & 0x3F]);
-        out.push_back(kAlphabet[n & 0x3F]);
+        out[0] = kAlphabet[(n >> 18) & 0x3F];
+        out[1] = kAlphabet[(n >> 12) & 0x3F];
+        out[2] = kAlphabet[(n >> 6) & 0x3F];
+        out[3] = kAlphabet[n & 0x3F];
+        out += 4;
         i += 3;
     }
 
     const size_t rem = len - i;
     if (rem == 1) {
         const uint32_t n = static_cast<uint32_t>(data[i]) << 16;
-        out.push_back(kAlphabet[(n >> 18) & 0x3F]);
-        out.push_back(kAlphabet[(n >> 12) & 0x3F]);
-        out.push_back('=');
-        out.push_back('=');
+        out[0] = kAlphabet[(n >> 18) & 0x3F];
+        out[1] = kAlphabet[(n >> 12) & 0x3F];
+        out[2] = '=';
+        out[3] = '=';
     } else if (rem == 2) {
         const uint32_t n = (static_cast<uint32_t>(data[i]) << 16) |
                            (static_cast<uint32_t>(data[i + 1]) << 8);
-        out.push_back(kAlphabet[(n >> 18) & 0x3F]);
-        out.push_back(kAlphabet[(n >> 12) & 0x3F]);
-        out.push_back(kAlphabet[(n >> 6) & 0x3F]);
-        out.push_back('=');
+        out[0] = kAlphabet[(n >> 18) & 0x3F];
+        out[1] = kAlphabet[(n >> 12) & 0x3F];
+        out[2] = kAlphabet[(n >> 6) & 0x3F];
+        out[3] = '=';
     }
+}
 
+} // namespace
+
+size_t Base64EncodedSize(size_t len) {
+    return ((len + 2) / 3) * 4;
+}
+
+void Base64Encode(const uint8_t* data, size_t len, char* out) {
+    const Kernels& k = ActiveKernels();
+    if (k.encode != nullptr) {
+        const size_t done = k.encode(data, len, out);
+        data += done;
+        out += (done / 3) * 4;
+        len -= done;
+    }
+    EncodeScalar(data, len, out);
+}
+
+std::string Base64Encode(const uint8_t* data, size_t len) {
+    std::string out(Base64EncodedSize(len), '\0');
+    Base64Encode(data, len, &out[0]);
     return out;
 }
 
@@ -65,42 +130,66 @@ std::string Base64Encode(const std::vector<uint8_t>& data) {
     return Base64Encode(data.data(), data.size());
 }
 
-bool Base64Decode(const std::string& input, std::vector<uint8_t>& out) {
-    static const std::array<int, 256> kDecode = BuildDecodeTable();
+size_t Base64DecodedMaxSize(size_t len) {
+    return (len / 4) * 3;
+}
 
-    std::vector<uint8_t> result;
-    result.reserve((input.size() / 4) * 3);
+bool Base64Decode(const char* input, size_t len, uint8_t* out, size_t outCap, size_t& outLen) {
+    static const std::array<int8_t, 256> kDecode = BuildDecodeTable();
+
+    size_t o = 0;
+    size_t i = 0;
+    const Kernels& k = ActiveKernels();
+    // Decodes the clean run starting at `i` with the SIMD kernel. Called up
+    // front and again after each whitespace byte on a quantum boundary, so
+    // line-wrapped input stays on the fast path between line breaks.
+    auto runKernel = [&]() {
+        if (k.decode == nullptr) {
+            return;
+        }
+        // Kernels write 3 bytes per 4 characters; keep them inside outCap.
+        const size_t room = ((outCap - o) / 3) * 4;
+        const size_t avail = len - i;
+        const size_t done = k.decode(input + i, avail < room ? avail : room, out + o);
+        i += done;
+        o += (done / 4) * 3;
+    };
+    runKernel();
 
     int vals[4] = {0, 0, 0, 0};
     int valCount = 0;
     int padCount = 0;
 
-    for (char c : input) {
-        if (std::isspace(static_cast<unsigned char>(c))) {
-            continue;
-        }
-        if (c == '=') {
+    while (i < len) {
+        const int v = kDecode[static_cast<unsigned char>(input[i++])];
+        if (v >= 0) {
+            vals[valCount++] = v;
+        } else if (v == kPad) {
             vals[valCount++] = 0;
             ++padCount;
-        } else {
-            const int v = kDecode[static_cast<unsigned char>(c)];
-            if (v < 0) {
-                return false;
+        } else if (v == kSpace) {
+            if (valCount == 0) {
+                runKernel();
             }
-            vals[valCount++] = v;
+            continue;
+        } else {
+            return false;
         }
 
         if (valCount == 4) {
+            if (o + 3 > outCap) {
+                return false;
+            }
             const uint32_t n = (static_cast<uint32_t>(vals[0]) << 18) |
                                (static_cast<uint32_t>(vals[1]) << 12) |
                                (static_cast<uint32_t>(vals[2]) << 6) |
                                static_cast<uint32_t>(vals[3]);
-            result.push_back(static_cast<uint8_t>((n >> 16) & 0xFF));
+            out[o++] = static_cast<uint8_t>((n >> 16) & 0xFF);
             if (padCount < 2) {
-                result.push_back(static_cast<uint8_t>((n >> 8) & 0xFF));
+                out[o++] = static_cast<uint8_t>((n >> 8) & 0xFF);
             }
             if (padCount < 1) {
-                result.push_back(static_cast<uint8_t>(n & 0xFF));
+                out[o++] = static_cast<uint8_t>(n & 0xFF);
             }
             valCount = 0;
             padCount = 0;
@@ -111,6 +200,17 @@ bool Base64Decode(const std::string& input, std::vector<uint8_t>& out) {
         return false;
     }
 
+    outLen = o;
+    return true;
+}
+
+bool Base64Decode(const std::string& input, std::vector<uint8_t>& out) {
+    std::vector<uint8_t> result(Base64DecodedMaxSize(input.size()));
+    size_t len = 0;
+    if (!Base64Decode(input.data(), input.size(), result.data(), result.size(), len)) {
+        return false;
+    }
+    result.resize(len);
     out.swap(result);
     return true;
 }
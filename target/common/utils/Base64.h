@@ -6,9 +6,24 @@
 
 namespace util {
 
+size_t Base64EncodedSize(size_t len);
+
+// Encodes into a caller-provided buffer of Base64EncodedSize(len) characters.
+// Uses the widest SIMD kernel the CPU supports (see DetectSimdLevel).
+void Base64Encode(const uint8_t* data, size_t len, char* out);
+
 std::string Base64Encode(const uint8_t* data, size_t len);
 std::string Base64Encode(const std::vector<uint8_t>& data);
 
 bool Base64Decode(const std::string& input, std::vector<uint8_t>& out);
 
+// Upper bound on the decoded size of `len` input characters.
+size_t Base64DecodedMaxSize(size_t len);
+
+// Decodes into a caller-provided buffer; `outCap` must be at least
+// Base64DecodedMaxSize(len). Whitespace is skipped as in Base64Decode.
+// Runs of plain alphabet characters between whitespace go through the
+// SIMD kernel; the rest is decoded by the scalar loop.
+bool Base64Decode(const char* input, size_t len, uint8_t* out, size_t outCap, size_t& outLen);
+
 } // namespace util
@@ -0,0 +1,285 @@
+#include "Base64Simd.h"
+
+#if defined(CS_BASE64_X86)
+
+#include <cstring>
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12's AVX-512 headers trip -Wmaybe-uninitialized on _mm512_undefined_*.
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+#if defined(__GNUC__)
+#define CS_TARGET(x) __attribute__((target(x)))
+#else
+#define CS_TARGET(x)
+#endif
+
+// Algorithms follow W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions" and "Base64 encoding and decoding at
+// almost the speed of a memory copy".
+namespace util {
+namespace simd {
+
+namespace {
+
+const char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+// 128-entry decode table for the VBMI kernel; 0x80 marks invalid input.
+struct VbmiTable {
+    int8_t values[128];
+};
+
+VbmiTable BuildVbmiTable() {
+    VbmiTable table;
+    std::memset(table.values, 0x80, sizeof(table.values));
+    for (int v = 0; v < 64; ++v) {
+        table.values[static_cast<unsigned char>(kAlphabet[v])] = static_cast<int8_t>(v);
+    }
+    return table;
+}
+
+// 12 input bytes (in the low 12 of each 128-bit lane) -> 16 6-bit indices.
+CS_TARGET("sse4.1")
+__m128i SplitSse(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+CS_TARGET("sse4.1")
+__m128i LookupSse(__m128i indices) {
+    __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+    const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    result = _mm_shuffle_epi8(shift, result);
+    return _mm_add_epi8(result, indices);
+}
+
+CS_TARGET("avx2")
+__m256i SplitAvx2(__m256i in) {
+    in = _mm256_shuffle_epi8(in, _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    return _mm256_or_si256(t1, t3);
+}
+
+CS_TARGET("avx2")
+__m256i LookupAvx2(__m256i indices) {
+    __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    const __m256i shift = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    result = _mm256_shuffle_epi8(shift, result);
+    return _mm256_add_epi8(result, indices);
+}
+
+// Maps 16 ASCII characters to 6-bit values; returns false if any byte is
+// outside the alphabet.
+CS_TARGET("sse4.1")
+bool TranslateSse(__m128i in, __m128i& out) {
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                        0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71,
+                                          0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask);
+    const __m128i loNibbles = _mm_and_si128(in, mask);
+    const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+    const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+    if (!_mm_testz_si128(lo, hi)) {
+        return false;
+    }
+    const __m128i eq2F = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+    const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+    out = _mm_add_epi8(in, roll);
+    return true;
+}
+
+CS_TARGET("avx2")
+bool TranslateAvx2(__m256i in, __m256i& out) {
+    const __m256i lutLo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m256i lutHi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    const __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+    const __m256i loNibbles = _mm256_and_si256(in, mask);
+    const __m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+    const __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+    if (!_mm256_testz_si256(lo, hi)) {
+        return false;
+    }
+    const __m256i eq2F = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+    const __m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+    out = _mm256_add_epi8(in, roll);
+    return true;
+}
+
+// 6-bit values -> 24-bit groups, one per 32-bit lane as [c, b, a, 0].
+CS_TARGET("sse4.1")
+__m128i PackSse(__m128i values) {
+    const __m128i ab = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    return _mm_madd_epi16(ab, _mm_set1_epi32(0x00011000));
+}
+
+CS_TARGET("avx2")
+__m256i PackAvx2(__m256i values) {
+    const __m256i ab = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    return _mm256_madd_epi16(ab, _mm256_set1_epi32(0x00011000));
+}
+
+} // namespace
+
+CS_TARGET("sse4.1")
+size_t EncodeSse41(const uint8_t* in, size_t len, char* out) {
+    size_t i = 0;
+    // Loads 16 bytes but consumes 12.
+    while (i + 16 <= len) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), LookupSse(SplitSse(block)));
+        out += 16;
+        i += 12;
+    }
+    return i;
+}
+
+CS_TARGET("avx2")
+size_t EncodeAvx2(const uint8_t* in, size_t len, char* out) {
+    size_t i = 0;
+    // Two 16-byte loads at +0 and +12; consumes 24.
+    while (i + 28 <= len) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+        const __m256i block = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), LookupAvx2(SplitAvx2(block)));
+        out += 32;
+        i += 24;
+    }
+    return i;
+}
+
+CS_TARGET("avx512f,avx512bw,avx512vbmi")
+size_t EncodeAvx512Vbmi(const uint8_t* in, size_t len, char* out) {
+    const __m512i shuffle = _mm512_setr_epi32(
+        0x01020001, 0x04050304, 0x07080607, 0x0a0b090a,
+        0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+        0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+        0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+    const __m512i lookup = _mm512_loadu_si512(reinterpret_cast<const void*>(kAlphabet));
+    const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040aLL);
+    const __mmask64 load48 = 0x0000FFFFFFFFFFFFULL;
+
+    size_t i = 0;
+    while (i + 48 <= len) {
+        const __m512i block = _mm512_maskz_loadu_epi8(load48, in + i);
+        const __m512i grouped = _mm512_permutexvar_epi8(shuffle, block);
+        const __m512i indices = _mm512_multishift_epi64_epi8(shifts, grouped);
+        _mm512_storeu_si512(reinterpret_cast<void*>(out), _mm512_permutexvar_epi8(indices, lookup));
+        out += 64;
+        i += 48;
+    }
+    return i;
+}
+
+CS_TARGET("sse4.1")
+size_t DecodeSse41(const char* in, size_t len, uint8_t* out) {
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t i = 0;
+    while (i + 16 <= len) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i values;
+        if (!TranslateSse(block, values)) {
+            break;
+        }
+        const __m128i bytes = _mm_shuffle_epi8(PackSse(values), pack);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bytes);
+        const int tail = _mm_extract_epi32(bytes, 2);
+        std::memcpy(out + 8, &tail, sizeof(tail));
+        out += 12;
+        i += 16;
+    }
+    return i;
+}
+
+CS_TARGET("avx2")
+size_t DecodeAvx2(const char* in, size_t len, uint8_t* out) {
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+    size_t i = 0;
+    while (i + 32 <= len) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i values;
+        if (!TranslateAvx2(block, values)) {
+            break;
+        }
+        const __m256i packed = _mm256_shuffle_epi8(PackAvx2(values), pack);
+        const __m256i bytes = _mm256_permutevar8x32_epi32(packed, lanes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(bytes));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), _mm256_extracti128_si256(bytes, 1));
+        out += 24;
+        i += 32;
+    }
+    return i;
+}
+
+CS_TARGET("avx512f,avx512bw,avx512vbmi")
+size_t DecodeAvx512Vbmi(const char* in, size_t len, uint8_t* out) {
+    static const VbmiTable kTable = BuildVbmiTable();
+    const __m512i lookup0 = _mm512_loadu_si512(reinterpret_cast<const void*>(kTable.values));
+    const __m512i lookup1 = _mm512_loadu_si512(reinterpret_cast<const void*>(kTable.values + 64));
+    const __m512i pack = _mm512_setr_epi32(
+        0x06000102, 0x090a0405, 0x0c0d0e08, 0x16101112,
+        0x191a1415, 0x1c1d1e18, 0x26202122, 0x292a2425,
+        0x2c2d2e28, 0x36303132, 0x393a3435, 0x3c3d3e38,
+        0, 0, 0, 0);
+    const __mmask64 store48 = 0x0000FFFFFFFFFFFFULL;
+
+    size_t i = 0;
+    while (i + 64 <= len) {
+        const __m512i block = _mm512_loadu_si512(reinterpret_cast<const void*>(in + i));
+        const __m512i values = _mm512_permutex2var_epi8(lookup0, block, lookup1);
+        if (_mm512_movepi8_mask(_mm512_or_si512(values, block)) != 0) {
+            break;
+        }
+        const __m512i ab = _mm512_maddubs_epi16(values, _mm512_set1_epi32(0x01400140));
+        const __m512i abc = _mm512_madd_epi16(ab, _mm512_set1_epi32(0x00011000));
+        _mm512_mask_storeu_epi8(out, store48, _mm512_permutexvar_epi8(pack, abc));
+        out += 48;
+        i += 64;
+    }
+    return i;
+}
+
+} // namespace simd
+} // namespace util
+
+#endif // CS_BASE64_X86
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vector Base64 kernels used by Base64.cpp. Each kernel handles whole blocks
+// only and returns how many input bytes it consumed; the caller finishes the
+// tail (and anything a decoder rejects, such as '=' or whitespace) with the
+// scalar code. Kernels never read or write outside the given ranges.
+namespace util {
+namespace simd {
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CS_BASE64_X86 1
+
+size_t EncodeSse41(const uint8_t* in, size_t len, char* out);
+size_t EncodeAvx2(const uint8_t* in, size_t len, char* out);
+size_t EncodeAvx512Vbmi(const uint8_t* in, size_t len, char* out);
+
+size_t DecodeSse41(const char* in, size_t len, uint8_t* out);
+size_t DecodeAvx2(const char* in, size_t len, uint8_t* out);
+size_t DecodeAvx512Vbmi(const char* in, size_t len, uint8_t* out);
+
+#endif
+
+} // namespace simd
+} // namespace util
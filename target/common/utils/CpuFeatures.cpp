@@ -0,0 +1,108 @@
+#include "CpuFeatures.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "Logger.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace util {
+
+namespace {
+
+SimdLevel DetectHardware() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vbmi")) {
+        return SimdLevel::Avx512Vbmi;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3")) {
+        return SimdLevel::Sse41;
+    }
+    return SimdLevel::Scalar;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int regs[4] = {0, 0, 0, 0};
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+    if (maxLeaf < 1) {
+        return SimdLevel::Scalar;
+    }
+    __cpuid(regs, 1);
+    const bool ssse3 = (regs[2] & (1 << 9)) != 0;
+    const bool sse41 = (regs[2] & (1 << 19)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!ssse3 || !sse41) {
+        return SimdLevel::Scalar;
+    }
+    if (!osxsave || !avx || maxLeaf < 7) {
+        return SimdLevel::Sse41;
+    }
+    const unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) {
+        return SimdLevel::Sse41;
+    }
+    __cpuidex(regs, 7, 0);
+    const bool avx2 = (regs[1] & (1 << 5)) != 0;
+    const bool avx512f = (regs[1] & (1 << 16)) != 0;
+    const bool avx512bw = (regs[1] & (1 << 30)) != 0;
+    const bool avx512vbmi = (regs[2] & (1 << 1)) != 0;
+    if (avx512f && avx512bw && avx512vbmi && (xcr0 & 0xE6) == 0xE6) {
+        return SimdLevel::Avx512Vbmi;
+    }
+    return avx2 ? SimdLevel::Avx2 : SimdLevel::Sse41;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel ApplyEnvCap(SimdLevel level) {
+    const char* cap = std::getenv("CS_SIMD");
+    if (cap == nullptr) {
+        return level;
+    }
+    SimdLevel limit = level;
+    if (std::strcmp(cap, "scalar") == 0) {
+        limit = SimdLevel::Scalar;
+    } else if (std::strcmp(cap, "sse41") == 0) {
+        limit = SimdLevel::Sse41;
+    } else if (std::strcmp(cap, "avx2") == 0) {
+        limit = SimdLevel::Avx2;
+    } else if (std::strcmp(cap, "avx512") == 0) {
+        limit = SimdLevel::Avx512Vbmi;
+    } else {
+        UTIL_LOG(Warn) << "CS_SIMD=" << cap << " not recognized (scalar | sse41 | avx2 | avx512); ignored";
+    }
+    return (static_cast<int>(limit) < static_cast<int>(level)) ? limit : level;
+}
+
+} // namespace
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel level = ApplyEnvCap(DetectHardware());
+    return level;
+}
+
+const char* SimdLevelToString(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Sse41:
+        return "sse41";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Avx512Vbmi:
+        return "avx512vbmi";
+    default:
+        return "unknown";
+    }
+}
+
+} // namespace util
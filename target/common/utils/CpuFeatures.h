@@ -0,0 +1,19 @@
+#pragma once
+
+namespace util {
+
+// Widest SIMD tier usable on this CPU/OS, in increasing order.
+enum class SimdLevel {
+    Scalar = 0,
+    Sse41,
+    Avx2,
+    Avx512Vbmi
+};
+
+// Detected once. The CS_SIMD environment variable (scalar | sse41 | avx2 |
+// avx512, the last meaning AVX-512 VBMI) caps the result, which is handy for
+// benchmarks and bug reports. Other values are logged and ignored.
+SimdLevel DetectSimdLevel();
+const char* SimdLevelToString(SimdLevel level);
+
+} // namespace util
@@ -0,0 +1,173 @@
+#include "EventLog.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace util {
+
+namespace {
+
+uint64_t NowUs() {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(
+        duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+std::string RotatedName(const std::string& path, uint32_t index) {
+    return index == 0 ? path : path + "." + std::to_string(index);
+}
+
+} // namespace
+
+EventLog::~EventLog() {
+    Close();
+}
+
+bool EventLog::Open(const std::string& path, uint64_t fileBytes, uint32_t keepFiles, std::string& err) {
+    Close();
+    if (path.empty() || keepFiles == 0 ||
+        fileBytes < sizeof(EventLogHeader) + sizeof(EventRecord)) {
+        err = "invalid event log settings";
+        return false;
+    }
+    path_ = path;
+    fileBytes_ = fileBytes - (fileBytes - sizeof(EventLogHeader)) % sizeof(EventRecord);
+    keepFiles_ = keepFiles;
+    Rotate();
+    return MapNew(err);
+}
+
+bool EventLog::Append(const EventRecord& rec, std::string& err) {
+    if (!base_) {
+        return false;
+    }
+    if (used_ + sizeof(EventRecord) > fileBytes_) {
+        Unmap();
+        Rotate();
+        if (!MapNew(err)) {
+            return false;
+        }
+    }
+    std::memcpy(base_ + used_, &rec, sizeof(rec));
+    used_ += sizeof(rec);
+    return true;
+}
+
+void EventLog::Close() {
+    Unmap();
+}
+
+void EventLog::Rotate() {
+    std::remove(RotatedName(path_, keepFiles_ - 1).c_str());
+    for (uint32_t i = keepFiles_ - 1; i > 0; --i) {
+        std::rename(RotatedName(path_, i - 1).c_str(), RotatedName(path_, i).c_str());
+    }
+}
+
+#ifdef _WIN32
+
+bool EventLog::MapNew(std::string& err) {
+    HANDLE file = CreateFileA(path_.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        err = "cannot create " + path_;
+        return false;
+    }
+    const DWORD high = static_cast<DWORD>(fileBytes_ >> 32);
+    const DWORD low = static_cast<DWORD>(fileBytes_ & 0xFFFFFFFFu);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, high, low, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        err = "cannot map " + path_;
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(fileBytes_));
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        err = "cannot map " + path_;
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    base_ = static_cast<char*>(view);
+
+    EventLogHeader header;
+    std::memcpy(header.magic, kEventLogMagic, sizeof(header.magic));
+    header.createdUs = NowUs();
+    std::memcpy(base_, &header, sizeof(header));
+    used_ = sizeof(header);
+    return true;
+}
+
+void EventLog::Unmap() {
+    if (!base_) {
+        return;
+    }
+    UnmapViewOfFile(base_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    LARGE_INTEGER pos;
+    pos.QuadPart = static_cast<LONGLONG>(used_);
+    SetFilePointerEx(static_cast<HANDLE>(file_), pos, nullptr, FILE_BEGIN);
+    SetEndOfFile(static_cast<HANDLE>(file_));
+    CloseHandle(static_cast<HANDLE>(file_));
+    base_ = nullptr;
+    mapping_ = nullptr;
+    file_ = nullptr;
+    used_ = 0;
+}
+
+#else
+
+bool EventLog::MapNew(std::string& err) {
+    const int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        err = "cannot create " + path_;
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(fileBytes_)) != 0) {
+        ::close(fd);
+        err = "cannot size " + path_;
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<size_t>(fileBytes_), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        err = "cannot map " + path_;
+        return false;
+    }
+    fd_ = fd;
+    base_ = static_cast<char*>(view);
+
+    EventLogHeader header;
+    std::memcpy(header.magic, kEventLogMagic, sizeof(header.magic));
+    header.createdUs = NowUs();
+    std::memcpy(base_, &header, sizeof(header));
+    used_ = sizeof(header);
+    return true;
+}
+
+void EventLog::Unmap() {
+    if (!base_) {
+        return;
+    }
+    ::munmap(base_, static_cast<size_t>(fileBytes_));
+    (void)::ftruncate(fd_, static_cast<off_t>(used_));
+    ::close(fd_);
+    base_ = nullptr;
+    fd_ = -1;
+    used_ = 0;
+}
+
+#endif
+
+} // namespace util
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace util {
+
+// One request as recorded in the binary event log. Fixed size, little-endian
+// on disk, written without any formatting; tools/EventDump renders it.
+struct EventRecord {
+    uint64_t timeUs = 0;      // Unix epoch, microseconds; 0 marks unused space
+    uint64_t connId = 0;
+    uint32_t latencyUs = 0;   // frame received to response sent
+    uint32_t bytesIn = 0;     // request payload
+    uint32_t bytesOut = 0;    // response frame
+    int32_t code = 0;         // protocol::ErrorCode value
+    uint16_t cmd = 0;         // server::CommandId; kUnknownCmd if not built in
+    uint16_t reserved = 0;
+    uint32_t reserved2 = 0;
+
+    static constexpr uint16_t kUnknownCmd = 0xFFFF;
+};
+static_assert(sizeof(EventRecord) == 40, "EventRecord is an on-disk format");
+
+// File layout: a 64-byte header, then EventRecords back to back. Files are
+// created at full size and memory-mapped, so appending is a memcpy. When a
+// file fills up, it is closed (trimmed to the records written) and files
+// rotate: `path` -> `path.1` -> ... -> `path.<keep-1>`; the oldest is
+// deleted.
+struct EventLogHeader {
+    char magic[8];            // kEventLogMagic
+    uint32_t version = 1;
+    uint32_t recordSize = sizeof(EventRecord);
+    uint64_t createdUs = 0;
+    uint8_t reserved[40] = {};
+};
+static_assert(sizeof(EventLogHeader) == 64, "EventLogHeader is an on-disk format");
+
+inline constexpr char kEventLogMagic[8] = {'C', 'S', 'E', 'V', 'L', 'O', 'G', '1'};
+
+// Single-threaded writer; Logger's writer thread owns it.
+class EventLog {
+public:
+    EventLog() = default;
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // `fileBytes` is the size of each file including the header; `keepFiles`
+    // counts the live file too.
+    bool Open(const std::string& path, uint64_t fileBytes, uint32_t keepFiles, std::string& err);
+    bool isOpen() const { return base_ != nullptr; }
+
+    // Rotates when the current file is full. Returns false if the log had to
+    // be closed because a new file could not be created.
+    bool Append(const EventRecord& rec, std::string& err);
+
+    void Close();
+
+private:
+    bool MapNew(std::string& err);
+    void Unmap();
+    void Rotate();
+
+    std::string path_;
+    uint64_t fileBytes_ = 0;
+    uint32_t keepFiles_ = 0;
+
+    char* base_ = nullptr;
+    uint64_t used_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace util
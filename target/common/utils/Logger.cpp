@@ -1,19 +1,20 @@
 #include "Logger.h"
 
-#include <chrono>
+#include <array>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
 #include <ctime>
-#include <iomanip>
-#include <iostream>
+#include <cstring>
+#include <memory>
 #include <mutex>
-#include <sstream>
+#include <thread>
+#include <vector>
 
 namespace util {
 
 namespace {
 
-LogLevel g_level = LogLevel::Info;
-std::mutex g_mutex;
-
 const char* levelToString(LogLevel level) {
     switch (level) {
     case LogLevel::Debug:
@@ -29,57 +30,292 @@ const char* levelToString(LogLevel level) {
     }
 }
 
-std::string nowString() {
-    using namespace std::chrono;
-    const auto now = system_clock::now();
-    const std::time_t tt = system_clock::to_time_t(now);
-    std::tm tm{};
-    localtime_s(&tm, &tt);
+// A text line, or an EventRecord copied into `text` when `event` is set.
+struct Record {
+    int64_t epochSec = 0;
+    LogLevel level = LogLevel::Info;
+    bool event = false;
+    uint16_t len = 0;
+    char text[Logger::kMaxLineBytes];
+};
+static_assert(sizeof(EventRecord) <= Logger::kMaxLineBytes, "events ride in text records");
 
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
-}
+// Single producer (the owning thread), single consumer (whoever holds
+// Backend::drainMutex_). head/tail only grow; slot = index % kSlots.
+struct Ring {
+    static constexpr size_t kSlots = 512;
+
+    std::array<Record, kSlots> slots;
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    std::atomic<bool> retired{false};
+};
+
+// Marks the ring retired when its thread exits; the writer frees it once
+// drained.
+struct RingHolder {
+    std::shared_ptr<Ring> ring;
+    ~RingHolder() {
+        if (ring) {
+            ring->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local RingHolder t_ring;
+
+class Backend {
+public:
+    // Never destroyed: detached session threads may log during exit. An
+    // atexit hook writes out whatever is still queued.
+    static Backend& Instance() {
+        static Backend* backend = new Backend();
+        return *backend;
+    }
+
+    Ring& LocalRing() {
+        if (!t_ring.ring) {
+            t_ring.ring = std::make_shared<Ring>();
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.push_back(t_ring.ring);
+        }
+        return *t_ring.ring;
+    }
+
+    void Push(LogLevel level, std::string_view msg, bool event) {
+        Ring& ring = LocalRing();
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) >= Ring::kSlots) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Record& r = ring.slots[head % Ring::kSlots];
+        r.epochSec = event ? 0 : static_cast<int64_t>(std::time(nullptr));
+        r.level = level;
+        r.event = event;
+        r.len = static_cast<uint16_t>(msg.size() < sizeof(r.text) ? msg.size() : sizeof(r.text));
+        std::memcpy(r.text, msg.data(), r.len);
+        ring.head.store(head + 1, std::memory_order_release);
+
+        // Pairs with the fence in WriterLoop(): either the writer sees this
+        // record before it sleeps, or this thread sees it idle and wakes it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (idle_.load(std::memory_order_relaxed) && idle_.exchange(false)) {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeCv_.notify_one();
+        }
+    }
+
+    bool OpenEvents(const std::string& path, uint64_t fileBytes, uint32_t keepFiles, std::string& err) {
+        std::lock_guard<std::mutex> drainLock(drainMutex_);
+        return events_.Open(path, fileBytes, keepFiles, err);
+    }
+
+    // Returns the number of lines written.
+    size_t Drain() {
+        std::lock_guard<std::mutex> drainLock(drainMutex_);
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            snapshot_ = rings_;
+        }
+
+        size_t written = 0;
+        for (const auto& ring : snapshot_) {
+            const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            const uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (uint64_t i = tail; i < head; ++i) {
+                Append(ring->slots[i % Ring::kSlots]);
+            }
+            ring->tail.store(head, std::memory_order_release);
+            written += static_cast<size_t>(head - tail);
+        }
+        snapshot_.clear();
+
+        const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops_) {
+            err_ += Timestamp(static_cast<int64_t>(std::time(nullptr)));
+            err_ += " [WARN] logger dropped " + std::to_string(dropped - reportedDrops_) + " lines\n";
+            reportedDrops_ = dropped;
+        }
+
+        if (!out_.empty()) {
+            std::fwrite(out_.data(), 1, out_.size(), stdout);
+            std::fflush(stdout);
+            out_.clear();
+        }
+        if (!err_.empty()) {
+            std::fwrite(err_.data(), 1, err_.size(), stderr);
+            std::fflush(stderr);
+            err_.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (size_t i = 0; i < rings_.size();) {
+            Ring& r = *rings_[i];
+            if (r.retired.load(std::memory_order_acquire) &&
+                r.tail.load(std::memory_order_relaxed) == r.head.load(std::memory_order_acquire)) {
+                rings_[i] = std::move(rings_.back());
+                rings_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        return written;
+    }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    Backend() {
+        std::thread([this]() { WriterLoop(); }).detach();
+        std::atexit([]() { Backend::Instance().Drain(); });
+    }
+
+    // Drains while there is work; once every ring is empty, sleeps until the
+    // next Push() instead of polling.
+    void WriterLoop() {
+        while (true) {
+            if (Drain() != 0) {
+                continue;
+            }
+            idle_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (Drain() != 0) {
+                idle_.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCv_.wait(lock, [this]() { return !idle_.load(std::memory_order_relaxed); });
+        }
+    }
+
+    void Append(const Record& r) {
+        if (r.event) {
+            AppendEvent(r);
+            return;
+        }
+        std::string& out = (r.level == LogLevel::Warn || r.level == LogLevel::Error) ? err_ : out_;
+        out += Timestamp(r.epochSec);
+        out += " [";
+        out += levelToString(r.level);
+        out += "] ";
+        out.append(r.text, r.len);
+        out += '\n';
+    }
+
+    void AppendEvent(const Record& r) {
+        if (!events_.isOpen()) {
+            return;
+        }
+        if (!Logger::eventsEnabled()) {
+            events_.Close();
+            return;
+        }
+        EventRecord rec;
+        std::memcpy(&rec, r.text, sizeof(rec));
+        std::string err;
+        if (!events_.Append(rec, err)) {
+            Logger::closeEventLog();
+            err_ += Timestamp(static_cast<int64_t>(std::time(nullptr)));
+            err_ += " [ERROR] event log closed: " + err + "\n";
+        }
+    }
+
+    // localtime_s runs once per distinct second.
+    const std::string& Timestamp(int64_t epochSec) {
+        if (epochSec != cachedSec_ || cachedStamp_.empty()) {
+            const std::time_t tt = static_cast<std::time_t>(epochSec);
+            std::tm tm{};
+            localtime_s(&tm, &tt);
+            char buf[32];
+            const size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+            cachedStamp_.assign(buf, n);
+            cachedSec_ = epochSec;
+        }
+        return cachedStamp_;
+    }
+
+    std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    // Everything below is owned by the holder of drainMutex_.
+    std::mutex drainMutex_;
+    std::vector<std::shared_ptr<Ring>> snapshot_;
+    std::string out_;
+    std::string err_;
+    int64_t cachedSec_ = 0;
+    std::string cachedStamp_;
+    uint64_t reportedDrops_ = 0;
+    EventLog events_;
+
+    std::atomic<uint64_t> dropped_{0};
+
+    // Set by the writer before it sleeps; cleared by the Push() that wakes it.
+    std::atomic<bool> idle_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+};
 
 } // namespace
 
 void Logger::setLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    g_level = level;
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
 LogLevel Logger::level() {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    return g_level;
+    return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
 }
 
-void Logger::log(LogLevel level, const std::string& msg) {
-    std::lock_guard<std::mutex> lock(g_mutex);
-    if (static_cast<int>(level) < static_cast<int>(g_level)) {
+void Logger::log(LogLevel level, std::string_view msg) {
+    if (!enabled(level)) {
         return;
     }
+    Backend::Instance().Push(level, msg, false);
+}
 
-    std::ostream& out = (level == LogLevel::Warn || level == LogLevel::Error)
-        ? std::cerr
-        : std::cout;
+bool Logger::openEventLog(const std::string& path, uint64_t fileBytes, uint32_t keepFiles,
+                          std::string& err) {
+    if (!Backend::Instance().OpenEvents(path, fileBytes, keepFiles, err)) {
+        return false;
+    }
+    events_.store(true, std::memory_order_relaxed);
+    return true;
+}
 
-    out << nowString() << " [" << levelToString(level) << "] " << msg << "\n";
+void Logger::event(const EventRecord& rec) {
+    if (!eventsEnabled()) {
+        return;
+    }
+    Backend::Instance().Push(LogLevel::Info,
+                             std::string_view(reinterpret_cast<const char*>(&rec), sizeof(rec)), true);
 }
 
-void Logger::debug(const std::string& msg) {
+void Logger::closeEventLog() {
+    events_.store(false, std::memory_order_relaxed);
+}
+
+void Logger::debug(std::string_view msg) {
     log(LogLevel::Debug, msg);
 }
 
-void Logger::info(const std::string& msg) {
+void Logger::info(std::string_view msg) {
     log(LogLevel::Info, msg);
 }
 
-void Logger::warn(const std::string& msg) {
+void Logger::warn(std::string_view msg) {
     log(LogLevel::Warn, msg);
 }
 
-void Logger::error(const std::string& msg) {
+void Logger::error(std::string_view msg) {
     log(LogLevel::Error, msg);
 }
 
+void Logger::flush() {
+    Backend::Instance().Drain();
+}
+
+uint64_t Logger::dropped() {
+    return Backend::Instance().dropped();
+}
+
 } // namespace util
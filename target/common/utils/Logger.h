@@ -1,6 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "EventLog.h"
 
 namespace util {
 
@@ -11,17 +19,93 @@ enum class LogLevel {
     Error
 };
 
+// Asynchronous logger. Each thread queues lines on its own lock-free ring;
+// a background writer drains the rings, prefixes a timestamp that is
+// formatted once per second, and writes Debug/Info to stdout and Warn/Error
+// to stderr. log() never blocks: when a thread's ring is full the line is
+// dropped and counted.
+//
+// Structured mode: once openEventLog() succeeds, event() queues binary
+// EventRecords on the same rings and the writer appends them to an EventLog,
+// so per-request logging costs a 40-byte copy and no formatting.
 class Logger {
 public:
+    // Longer lines are truncated.
+    static constexpr size_t kMaxLineBytes = 240;
+
     static void setLevel(LogLevel level);
     static LogLevel level();
 
-    static void log(LogLevel level, const std::string& msg);
+    // Checked before any formatting; see UTIL_LOG.
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    static void log(LogLevel level, std::string_view msg);
+
+    static void debug(std::string_view msg);
+    static void info(std::string_view msg);
+    static void warn(std::string_view msg);
+    static void error(std::string_view msg);
+
+    // Call once at startup.
+    static bool openEventLog(const std::string& path, uint64_t fileBytes, uint32_t keepFiles,
+                             std::string& err);
+    static bool eventsEnabled() { return events_.load(std::memory_order_relaxed); }
+    static void event(const EventRecord& rec);
+    // Stops recording events; the writer closes the file on its next pass.
+    static void closeEventLog();
+
+    // Blocks until every line and event queued before the call has been
+    // written.
+    static void flush();
+    static uint64_t dropped();
+
+private:
+    static inline std::atomic<int> level_{static_cast<int>(LogLevel::Info)};
+    static inline std::atomic<bool> events_{false};
+};
+
+// Builds one line in a fixed buffer without allocating and queues it when
+// destroyed. Use through UTIL_LOG so nothing is formatted for filtered levels.
+class LogLine {
+public:
+    explicit LogLine(LogLevel level) : level_(level) {}
+    ~LogLine() { Logger::log(level_, std::string_view(buf_, len_)); }
+
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
 
-    static void debug(const std::string& msg);
-    static void info(const std::string& msg);
-    static void warn(const std::string& msg);
-    static void error(const std::string& msg);
+    LogLine& operator<<(std::string_view s) {
+        const size_t n = s.size() < sizeof(buf_) - len_ ? s.size() : sizeof(buf_) - len_;
+        s.copy(buf_ + len_, n);
+        len_ += n;
+        return *this;
+    }
+    LogLine& operator<<(const char* s) { return *this << std::string_view(s); }
+    LogLine& operator<<(const std::string& s) { return *this << std::string_view(s); }
+    LogLine& operator<<(char c) { return *this << std::string_view(&c, 1); }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                                      !std::is_same_v<T, char>>>
+    LogLine& operator<<(T v) {
+        const auto r = std::to_chars(buf_ + len_, buf_ + sizeof(buf_), v);
+        if (r.ec == std::errc()) {
+            len_ = static_cast<size_t>(r.ptr - buf_);
+        }
+        return *this;
+    }
+
+private:
+    LogLevel level_;
+    size_t len_ = 0;
+    char buf_[Logger::kMaxLineBytes];
 };
 
 } // namespace util
+
+// UTIL_LOG(Info) << "client connected id=" << id;
+#define UTIL_LOG(lvl) \
+    if (!::util::Logger::enabled(::util::LogLevel::lvl)) { \
+    } else \
+        ::util::LogLine(::util::LogLevel::lvl)
@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <cctype>
 
+#include "../../common/net/FramedIO.h"
 #include "../../common/protocol/ErrorCode.h"
+#include "Trace.h"
 
 namespace server {
 
@@ -16,68 +18,149 @@ std::string ToUpper(std::string s) {
     return s;
 }
 
-protocol::ResponseMessage MakeError(protocol::ErrorCode code, const std::string& msg) {
-    protocol::ResponseMessage resp;
-    resp.ok = false;
-    resp.code = code;
-    resp.msg = msg;
-    return resp;
+} // namespace
+
+CommandRouter::CommandRouter() {
+    interceptors_.push_back(std::make_unique<PermissionInterceptor>());
 }
 
-protocol::ErrorCode CheckPermission(Session::Level need, Session::Level cur) {
-    if (static_cast<int>(cur) >= static_cast<int>(need)) {
-        return protocol::ErrorCode::Ok;
-    }
-    if (need == Session::Level::Low) {
-        return protocol::ErrorCode::NotLogin;
-    }
-    if (need == Session::Level::High) {
-        return (cur == Session::Level::Guest)
-            ? protocol::ErrorCode::NotLogin
-            : protocol::ErrorCode::NoPermission;
-    }
-    return protocol::ErrorCode::Ok;
+void CommandRouter::AddInterceptor(std::unique_ptr<Interceptor> interceptor) {
+    interceptors_.push_back(std::move(interceptor));
 }
 
-} // namespace
+void CommandRouter::AddRoute(const std::string& cmd, Route route) {
+    CommandId id;
+    if (LookupCommand(cmd, id)) {
+        table_[static_cast<size_t>(id)] = std::move(route);
+        return;
+    }
+    dynamic_[ToUpper(cmd)] = std::move(route);
+}
 
-void CommandRouter::RegisterCommand(const std::string& cmd, Session::Level required, Handler handler) {
+void CommandRouter::RegisterStatic(const std::string& cmd, Session::Level required, StaticReply reply) {
     Route r;
     r.required = required;
-    r.handler = std::move(handler);
-    routes_[ToUpper(cmd)] = std::move(r);
+    r.reply = reply;
+    AddRoute(cmd, std::move(r));
 }
 
-bool CommandRouter::Handle(Session& session, const std::string& reqJson, std::string& respJson) {
-    protocol::RequestMessage req;
-    protocol::ErrorCode err = protocol::ErrorCode::Ok;
-    if (!protocol::DecodeRequest(reqJson, req, err)) {
-        protocol::ResponseMessage resp = MakeError(protocol::ErrorCode::BadRequest, "bad request");
-        return protocol::EncodeResponse(resp, respJson);
+const CommandRouter::Route* CommandRouter::FindRoute(const std::string& cmd, CommandId& id) const {
+    if (LookupCommand(cmd, id)) {
+        const Route& r = table_[static_cast<size_t>(id)];
+        return (r.fn || r.reply != StaticReply::None) ? &r : nullptr;
+    }
+    id = CommandId::Count;
+    if (dynamic_.empty()) {
+        return nullptr;
     }
+    auto it = dynamic_.find(ToUpper(cmd));
+    return it == dynamic_.end() ? nullptr : &it->second;
+}
 
-    const std::string cmd = ToUpper(req.cmd);
-    auto it = routes_.find(cmd);
-    if (it == routes_.end()) {
-        protocol::ResponseMessage resp = MakeError(protocol::ErrorCode::UnknownCmd, "unknown cmd");
-        return protocol::EncodeResponse(resp, respJson);
+bool CommandRouter::Handle(Session& session, RequestContext& ctx) {
+    Tracer::Instance().BeginRequest(ctx);
+    if (!ctx.decoded) {
+        ctx.mark(RequestContext::Mark::Permitted);
+        ctx.mark(RequestContext::Mark::Handled);
+        ctx.staticFrame = StaticReplyFrame(StaticReply::BadRequest);
+        ctx.code = protocol::ErrorCode::BadRequest;
+        ctx.mark(RequestContext::Mark::Encoded);
+        return true;
     }
 
-    const protocol::ErrorCode perm = CheckPermission(it->second.required, session.level());
-    if (perm != protocol::ErrorCode::Ok) {
-        const char* msg = (perm == protocol::ErrorCode::NotLogin)
-            ? (cmd == "LOGIN_HIGH" ? "need low login" : "not login")
-            : "no permission";
-        protocol::ResponseMessage resp = MakeError(perm, msg);
-        return protocol::EncodeResponse(resp, respJson);
+    // Entries are keyed by session level and only successful responses are
+    // stored, so a hit implies PermissionInterceptor would have let it pass.
+    // No interceptor runs on a hit (see Interceptor.h).
+    CommandId id = CommandId::Count;
+    const bool cacheable = LookupCommand(ctx.req.cmd, id) && cache_.enabled(id);
+    ctx.cmd = id;
+    uint64_t generation = 0;
+    std::string cacheKey;
+    if (cacheable) {
+        generation = cache_.Generation(id);
+        cache_.MakeKey(id, session.level(), ctx.req, cacheKey);
+        if (cache_.Lookup(id, cacheKey, generation, ctx.out)) {
+            ctx.mark(RequestContext::Mark::Permitted);
+            ctx.mark(RequestContext::Mark::Handled);
+            ctx.mark(RequestContext::Mark::Encoded);
+            return true;
+        }
     }
 
     protocol::ResponseMessage resp;
+    const StaticReply reply = Dispatch(session, ctx.req, resp, &ctx);
+    ctx.mark(RequestContext::Mark::Handled);
+    ctx.code = resp.code;
+
+    if (reply != StaticReply::None) {
+        ctx.staticFrame = StaticReplyFrame(reply);
+    } else if (!protocol::AppendResponse(resp, ctx.out)) {
+        // Typically a response over the size limit (e.g. a large BATCH);
+        // answer with an error instead of dropping the connection.
+        ctx.staticFrame = StaticReplyFrame(StaticReply::ResponseTooLarge);
+        ctx.code = protocol::ErrorCode::InternalError;
+    } else if (cacheable && resp.ok) {
+        cache_.Store(cacheKey, generation, std::string_view(ctx.out).substr(net::kFrameHeaderSize));
+    }
+    ctx.mark(RequestContext::Mark::Encoded);
+    return true;
+}
+
+void CommandRouter::Complete(RequestContext& ctx) {
+    ctx.mark(RequestContext::Mark::Sent);
+    stats_->Record(ctx);
+    Tracer::Instance().EndRequest(ctx);
+}
+
+void CommandRouter::Execute(Session& session,
+                            const protocol::RequestMessage& req,
+                            protocol::ResponseMessage& resp) {
+    Dispatch(session, req, resp, nullptr);
+}
+
+StaticReply CommandRouter::Dispatch(Session& session,
+                                    const protocol::RequestMessage& req,
+                                    protocol::ResponseMessage& resp,
+                                    RequestContext* ctx) {
+    CommandId id = CommandId::Count;
+    const Route* route = FindRoute(req.cmd, id);
+    if (!route) {
+        if (ctx) {
+            ctx->mark(RequestContext::Mark::Permitted);
+        }
+        FillStaticReply(StaticReply::UnknownCmd, resp);
+        return StaticReply::UnknownCmd;
+    }
+
+    CallInfo call{session, req, id, route->required, ctx};
     resp.ok = true;
     resp.code = protocol::ErrorCode::Ok;
     resp.msg = "OK";
-    it->second.handler(req, session, resp);
-    return protocol::EncodeResponse(resp, respJson);
+
+    size_t ran = 0;
+    bool proceed = true;
+    while (ran < interceptors_.size()) {
+        proceed = interceptors_[ran]->Before(call, resp);
+        ++ran;
+        if (!proceed) {
+            break;
+        }
+    }
+    if (ctx) {
+        ctx->mark(RequestContext::Mark::Permitted);
+    }
+    if (proceed) {
+        if (route->reply != StaticReply::None) {
+            FillStaticReply(route->reply, resp);
+            call.reply = route->reply;
+        } else {
+            route->fn(route->state.get(), req, session, resp);
+        }
+    }
+    while (ran > 0) {
+        interceptors_[--ran]->After(call, resp);
+    }
+    return call.reply;
 }
 
 } // namespace server
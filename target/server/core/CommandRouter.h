@@ -1,31 +1,130 @@
 #pragma once
 
-#include <functional>
+#include <array>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "../../common/protocol/Message.h"
+#include "CommandTable.h"
+#include "Interceptor.h"
+#include "RequestContext.h"
+#include "ResponseCache.h"
 #include "Session.h"
+#include "Stats.h"
+#include "Task.h"
 
 namespace server {
 
 class CommandRouter {
 public:
-    using Handler = std::function<void(const protocol::RequestMessage&,
-                                       Session&,
-                                       protocol::ResponseMessage&)>;
+    // Handlers are stored as a plain function pointer plus an opaque state
+    // pointer (the handler object itself), so dispatch is one indirect call.
+    using HandlerFn = void (*)(void* state,
+                               const protocol::RequestMessage&,
+                               Session&,
+                               protocol::ResponseMessage&);
 
-    void RegisterCommand(const std::string& cmd, Session::Level required, Handler handler);
+    // Installs PermissionInterceptor as the first interceptor.
+    CommandRouter();
 
-    bool Handle(Session& session, const std::string& reqJson, std::string& respJson);
+    // Appends to the interceptor chain. Call during startup only; the chain
+    // is read without locking while requests are served.
+    void AddInterceptor(std::unique_ptr<Interceptor> interceptor);
+
+    // Commands listed in CommandTable.h land in a fixed array slot; other
+    // names go to a runtime map keyed by the upper-cased name.
+    //
+    // `handler` is either a plain callable filling the response before it
+    // returns, or a coroutine returning Task<> that may co_await (e.g.
+    // RunOnIoPool, or ReadAhead::Take in DOWNLOAD_CHUNK) before it fills the
+    // response. Coroutine handlers are driven to completion with SyncWait:
+    // the session thread still waits for the reply, but no pool thread is
+    // held while the handler is suspended, and the handler always resumes on
+    // the session thread.
+    template <typename F>
+    void RegisterCommand(const std::string& cmd, Session::Level required, F&& handler);
+
+    // A command that always succeeds with the same canned reply; Handle()
+    // sends its pre-serialized frame without calling a handler or encoding.
+    void RegisterStatic(const std::string& cmd, Session::Level required, StaticReply reply);
+
+    // Routes the already-decoded `ctx.req` and appends the encoded response
+    // to `ctx.out`, or points `ctx.staticFrame` at a canned frame, stamping
+    // the Handled and Encoded marks. Commands enabled
+    // in cache() are answered from stored bytes when the entry is current,
+    // bypassing the interceptors and the handler.
+    bool Handle(Session& session, RequestContext& ctx);
+
+    // Call once the response in `ctx` has been sent: stamps Sent, records
+    // the request in stats() and, when it was sampled, in the Tracer.
+    void Complete(RequestContext& ctx);
+
+    // Configure during startup, like AddInterceptor.
+    ResponseCache& cache() { return cache_; }
+
+    CommandStats& stats() { return *stats_; }
+
+    // Routes one already-built message through lookup, the interceptor chain
+    // and its handler, without encoding. Used for BATCH sub-requests.
+    //
+    // No RequestContext is involved, so the call is not recorded on its own:
+    // STATS, /metrics and the event log count and time the whole BATCH as one
+    // request, and a sampled BATCH trace shows the sub-handlers' TraceSpans
+    // inside its handler stage but no stage spans per sub-request.
+    void Execute(Session& session,
+                 const protocol::RequestMessage& req,
+                 protocol::ResponseMessage& resp);
 
 private:
     struct Route {
         Session::Level required = Session::Level::Guest;
-        Handler handler;
+        HandlerFn fn = nullptr;
+        std::shared_ptr<void> state;
+        StaticReply reply = StaticReply::None;
     };
 
-    std::unordered_map<std::string, Route> routes_;
+    void AddRoute(const std::string& cmd, Route route);
+    const Route* FindRoute(const std::string& cmd, CommandId& id) const;
+    // Returns the canned reply `resp` holds, or StaticReply::None.
+    StaticReply Dispatch(Session& session,
+                         const protocol::RequestMessage& req,
+                         protocol::ResponseMessage& resp,
+                         RequestContext* ctx);
+
+    std::array<Route, kCommandCount> table_;
+    std::unordered_map<std::string, Route> dynamic_;
+    std::vector<std::unique_ptr<Interceptor>> interceptors_;
+    ResponseCache cache_;
+    // Several hundred KB of counters; kept off the stack of whoever owns the
+    // router.
+    std::unique_ptr<CommandStats> stats_ = std::make_unique<CommandStats>();
 };
 
+template <typename F>
+void CommandRouter::RegisterCommand(const std::string& cmd, Session::Level required, F&& handler) {
+    using Fn = std::decay_t<F>;
+    Route r;
+    r.required = required;
+    r.state = std::make_shared<Fn>(std::forward<F>(handler));
+    r.fn = [](void* state,
+              const protocol::RequestMessage& req,
+              Session& session,
+              protocol::ResponseMessage& resp) {
+        using Result = std::invoke_result_t<Fn&,
+                                            const protocol::RequestMessage&,
+                                            Session&,
+                                            protocol::ResponseMessage&>;
+        if constexpr (std::is_same_v<Result, Task<>>) {
+            SyncWait((*static_cast<Fn*>(state))(req, session, resp));
+        } else {
+            (*static_cast<Fn*>(state))(req, session, resp);
+        }
+    };
+    AddRoute(cmd, std::move(r));
+}
+
 } // namespace server
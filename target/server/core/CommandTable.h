@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace server {
+
+// Commands known at compile time. CommandRouter keeps their routes in a flat
+// array indexed by CommandId; anything else goes through its runtime map.
+//
+// The values are stored in the event log (EventRecord::cmd), so existing ids
+// never change: add new commands just before Count, and their names at the
+// end of kCommandNames.
+enum class CommandId : uint8_t {
+    Ping = 0,
+    Help,
+    Echo,
+    Whoami,
+    Time,
+    Batch,
+    LoginLow,
+    LoginHigh,
+    Logout,
+    AdminPing,
+    Run,
+    ReloadConfig,
+    ListFiles,
+    UploadInit,
+    UploadChunk,
+    UploadFinish,
+    DownloadInit,
+    DownloadChunk,
+    DownloadAbort,
+    Stats,
+    TraceDump,
+    Count
+};
+
+constexpr size_t kCommandCount = static_cast<size_t>(CommandId::Count);
+
+// Indexed by CommandId; names are upper case.
+inline constexpr std::array<std::string_view, kCommandCount> kCommandNames = {
+    "PING",
+    "HELP",
+    "ECHO",
+    "WHOAMI",
+    "TIME",
+    "BATCH",
+    "LOGIN_LOW",
+    "LOGIN_HIGH",
+    "LOGOUT",
+    "ADMIN_PING",
+    "RUN",
+    "RELOAD_CONFIG",
+    "LIST_FILES",
+    "UPLOAD_INIT",
+    "UPLOAD_CHUNK",
+    "UPLOAD_FINISH",
+    "DOWNLOAD_INIT",
+    "DOWNLOAD_CHUNK",
+    "DOWNLOAD_ABORT",
+    "STATS",
+    "TRACE_DUMP",
+};
+
+namespace detail {
+
+constexpr char AsciiUpper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// FNV-1a over the upper-cased name, so lookups are case-insensitive without
+// building an upper-case copy.
+constexpr uint32_t HashCommand(std::string_view s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(AsciiUpper(c));
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+constexpr size_t kCommandSlots = 64;
+static_assert(kCommandSlots >= kCommandCount, "command table needs more slots");
+
+constexpr bool SeedIsPerfect(uint32_t seed) {
+    std::array<bool, kCommandSlots> used{};
+    for (std::string_view name : kCommandNames) {
+        const size_t slot = HashCommand(name, seed) % kCommandSlots;
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t FindPerfectSeed() {
+    for (uint32_t seed = 1; seed < (1u << 20); ++seed) {
+        if (SeedIsPerfect(seed)) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+inline constexpr uint32_t kCommandSeed = FindPerfectSeed();
+static_assert(kCommandSeed != 0, "no collision-free seed for the command table");
+
+constexpr std::array<uint8_t, kCommandSlots> BuildCommandSlots() {
+    std::array<uint8_t, kCommandSlots> slots{};
+    for (auto& s : slots) {
+        s = static_cast<uint8_t>(CommandId::Count);
+    }
+    for (size_t i = 0; i < kCommandCount; ++i) {
+        slots[HashCommand(kCommandNames[i], kCommandSeed) % kCommandSlots] = static_cast<uint8_t>(i);
+    }
+    return slots;
+}
+
+inline constexpr std::array<uint8_t, kCommandSlots> kCommandSlotTable = BuildCommandSlots();
+
+constexpr bool EqualsIgnoreCase(std::string_view a, std::string_view upper) {
+    if (a.size() != upper.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (AsciiUpper(a[i]) != upper[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+// One hash, one slot load and one compare; no allocation.
+constexpr bool LookupCommand(std::string_view name, CommandId& out) {
+    const uint8_t idx =
+        detail::kCommandSlotTable[detail::HashCommand(name, detail::kCommandSeed) % detail::kCommandSlots];
+    if (idx >= kCommandCount || !detail::EqualsIgnoreCase(name, kCommandNames[idx])) {
+        return false;
+    }
+    out = static_cast<CommandId>(idx);
+    return true;
+}
+
+constexpr std::string_view CommandName(CommandId id) {
+    return kCommandNames[static_cast<size_t>(id)];
+}
+
+} // namespace server
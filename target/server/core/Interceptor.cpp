@@ -0,0 +1,38 @@
+#include "Interceptor.h"
+
+#include "../../common/protocol/ErrorCode.h"
+
+namespace server {
+
+namespace {
+
+protocol::ErrorCode CheckPermission(Session::Level need, Session::Level cur) {
+    if (static_cast<int>(cur) >= static_cast<int>(need)) {
+        return protocol::ErrorCode::Ok;
+    }
+    if (need == Session::Level::Low) {
+        return protocol::ErrorCode::NotLogin;
+    }
+    if (need == Session::Level::High) {
+        return (cur == Session::Level::Guest)
+            ? protocol::ErrorCode::NotLogin
+            : protocol::ErrorCode::NoPermission;
+    }
+    return protocol::ErrorCode::Ok;
+}
+
+} // namespace
+
+bool PermissionInterceptor::Before(CallInfo& call, protocol::ResponseMessage& resp) {
+    const protocol::ErrorCode perm = CheckPermission(call.required, call.session.level());
+    if (perm == protocol::ErrorCode::Ok) {
+        return true;
+    }
+    call.reply = (perm == protocol::ErrorCode::NotLogin)
+        ? (call.id == CommandId::LoginHigh ? StaticReply::NeedLowLogin : StaticReply::NotLogin)
+        : StaticReply::NoPermission;
+    FillStaticReply(call.reply, resp);
+    return false;
+}
+
+} // namespace server
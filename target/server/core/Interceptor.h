@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../../common/protocol/Message.h"
+#include "CommandTable.h"
+#include "Session.h"
+#include "StaticReplies.h"
+
+namespace server {
+
+struct RequestContext;
+
+// The routed call as seen by interceptors.
+struct CallInfo {
+    Session& session;
+    const protocol::RequestMessage& req;
+    // CommandId::Count for commands registered at runtime.
+    CommandId id = CommandId::Count;
+    Session::Level required = Session::Level::Guest;
+    // Null when the call does not come straight from a client frame.
+    RequestContext* ctx = nullptr;
+    // Set alongside `resp` when it holds one of the canned replies, so the
+    // router can send the pre-serialized frame. Anything that changes `resp`
+    // afterwards must reset it to None.
+    StaticReply reply = StaticReply::None;
+};
+
+// Hook around command handlers. Interceptors are added to the router at
+// startup and run in order: Before() hooks first, then the handler, then the
+// After() hooks in reverse order. Returning false from Before() skips the
+// handler and the remaining Before() hooks; `resp` is sent as filled in, and
+// the After() hooks of interceptors that already ran still see it.
+//
+// Hits in the router's ResponseCache bypass the whole chain: the stored
+// frame is sent without calling Before(), the handler or After(). Entries are
+// keyed by session level, so this is equivalent to PermissionInterceptor
+// passing the call. An interceptor that must see every call of a command
+// (auditing, rate limiting, ...) requires that command to stay uncached.
+class Interceptor {
+public:
+    virtual ~Interceptor() = default;
+
+    virtual bool Before(CallInfo& call, protocol::ResponseMessage& resp) {
+        (void)call;
+        (void)resp;
+        return true;
+    }
+
+    virtual void After(CallInfo& call, protocol::ResponseMessage& resp) {
+        (void)call;
+        (void)resp;
+    }
+};
+
+// Rejects calls below the command's required level. Always installed first.
+class PermissionInterceptor : public Interceptor {
+public:
+    bool Before(CallInfo& call, protocol::ResponseMessage& resp) override;
+};
+
+} // namespace server
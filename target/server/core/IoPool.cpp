@@ -0,0 +1,72 @@
+#include "IoPool.h"
+
+#include <exception>
+
+#include "../../common/utils/Logger.h"
+
+namespace server {
+
+namespace {
+
+const size_t kIoThreads = 4;
+
+} // namespace
+
+IoPool& IoPool::Instance() {
+    static IoPool pool(kIoThreads);
+    return pool;
+}
+
+IoPool::IoPool(size_t threads) {
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { Run(); });
+    }
+}
+
+IoPool::~IoPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+}
+
+void IoPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    cv_.notify_one();
+}
+
+void IoPool::Run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        // Tasks report their own failures; this only keeps one that throws
+        // from terminating the process.
+        try {
+            task();
+        } catch (const std::exception& e) {
+            UTIL_LOG(Error) << "IoPool task threw: " << e.what();
+        } catch (...) {
+            UTIL_LOG(Error) << "IoPool task threw";
+        }
+    }
+}
+
+} // namespace server
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace server {
+
+// Small fixed pool of background threads for blocking file I/O.
+class IoPool {
+public:
+    static IoPool& Instance();
+
+    explicit IoPool(size_t threads);
+    ~IoPool();
+
+    IoPool(const IoPool&) = delete;
+    IoPool& operator=(const IoPool&) = delete;
+
+    void Submit(std::function<void()> task);
+    // Lock-free, so monitoring never contends with Submit().
+    size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    std::atomic<size_t> pending_{0};
+};
+
+} // namespace server
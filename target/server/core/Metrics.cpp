@@ -0,0 +1,179 @@
+#include "Metrics.h"
+
+#include <array>
+#include <cstdio>
+
+#include "../../common/utils/Logger.h"
+#include "CommandRouter.h"
+#include "IoPool.h"
+#include "SharedReadGroup.h"
+
+namespace server {
+
+namespace {
+
+// Histogram bucket bounds in microseconds. Internal buckets do not line up
+// with these exactly; each is counted under the first bound at or above its
+// upper edge, which overstates latencies by at most ~6%.
+constexpr std::array<uint64_t, 17> kBoundsUs = {
+    50, 100, 250, 500,
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000,
+};
+
+void AppendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void AppendSample(std::string& out, const char* name, const std::string& labels, uint64_t value) {
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    out += std::to_string(value);
+    out += '\n';
+}
+
+void AppendSample(std::string& out, const char* name, const std::string& labels, int64_t value) {
+    AppendSample(out, name, labels, static_cast<uint64_t>(value < 0 ? 0 : value));
+}
+
+std::string Seconds(uint64_t us) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", static_cast<double>(us) / 1e6);
+    return buf;
+}
+
+std::string CmdLabel(size_t slot) {
+    return std::string("cmd=\"") + CommandStats::SlotName(slot) + "\"";
+}
+
+void AppendCommandMetrics(std::string& out, const CommandStats& stats) {
+    using Phase = CommandStats::Phase;
+    std::array<bool, CommandStats::kSlots> seen{};
+    for (size_t slot = 0; slot < CommandStats::kSlots; ++slot) {
+        seen[slot] = stats.totalCount(slot) != 0;
+    }
+
+    // One pass per metric family, as the text format requires families to
+    // be contiguous.
+    CommandStats::Snapshot snap;
+    std::string requests;
+    std::string errors;
+    std::string bytesIn;
+    std::string bytesOut;
+    std::string latency;
+    std::string phases;
+    for (size_t slot = 0; slot < CommandStats::kSlots; ++slot) {
+        if (!seen[slot]) {
+            continue;
+        }
+        // Totals since startup: STATS reset must not make counters go back.
+        stats.LoadTotal(slot, snap);
+        const std::string cmd = CmdLabel(slot);
+        AppendSample(requests, "cs_requests_total", cmd, snap.count);
+        AppendSample(errors, "cs_request_errors_total", cmd, snap.errors);
+        AppendSample(bytesIn, "cs_request_bytes_total", cmd, snap.bytesIn);
+        AppendSample(bytesOut, "cs_response_bytes_total", cmd, snap.bytesOut);
+
+        const LatencyHistogram::Snapshot& total = snap.phases[static_cast<size_t>(Phase::Total)];
+        size_t bucket = 0;
+        uint64_t cumulative = 0;
+        for (uint64_t bound : kBoundsUs) {
+            while (bucket < LatencyHistogram::kBuckets && LatencyHistogram::BucketHigh(bucket) <= bound) {
+                cumulative += total.buckets[bucket++];
+            }
+            AppendSample(latency, "cs_request_duration_seconds_bucket",
+                         cmd + ",le=\"" + Seconds(bound) + "\"", cumulative);
+        }
+        AppendSample(latency, "cs_request_duration_seconds_bucket", cmd + ",le=\"+Inf\"", total.count);
+        latency += "cs_request_duration_seconds_sum{" + cmd + "} " + Seconds(total.sum) + "\n";
+        AppendSample(latency, "cs_request_duration_seconds_count", cmd, total.count);
+
+        for (size_t p = 0; p < CommandStats::kPhaseCount; ++p) {
+            if (static_cast<Phase>(p) == Phase::Total) {
+                continue;
+            }
+            const LatencyHistogram::Snapshot& h = snap.phases[p];
+            const std::string labels = cmd + ",phase=\"" + CommandStats::PhaseName(static_cast<Phase>(p)) + "\"";
+            for (double q : {0.5, 0.99}) {
+                char qbuf[16];
+                std::snprintf(qbuf, sizeof(qbuf), "%g", q);
+                phases += "cs_request_phase_seconds{" + labels + ",quantile=\"" + qbuf + "\"} " +
+                          Seconds(h.Percentile(q)) + "\n";
+            }
+            phases += "cs_request_phase_seconds_sum{" + labels + "} " + Seconds(h.sum) + "\n";
+            AppendSample(phases, "cs_request_phase_seconds_count", labels, h.count);
+        }
+    }
+
+    AppendHeader(out, "cs_requests_total", "counter", "Requests answered, by command.");
+    out += requests;
+    AppendHeader(out, "cs_request_errors_total", "counter", "Requests answered with a non-zero code.");
+    out += errors;
+    AppendHeader(out, "cs_request_bytes_total", "counter", "Request payload bytes received.");
+    out += bytesIn;
+    AppendHeader(out, "cs_response_bytes_total", "counter", "Response frame bytes sent.");
+    out += bytesOut;
+    AppendHeader(out, "cs_request_duration_seconds", "histogram",
+                 "Time from frame received to response sent.");
+    out += latency;
+    AppendHeader(out, "cs_request_phase_seconds", "summary",
+                 "Per-phase request time: decode, permission, handler, encode, send.");
+    out += phases;
+}
+
+} // namespace
+
+ServerMetrics& ServerMetrics::Instance() {
+    static ServerMetrics metrics;
+    return metrics;
+}
+
+std::string RenderMetrics(CommandRouter& router) {
+    const ServerMetrics& m = ServerMetrics::Instance();
+    std::string out;
+    out.reserve(16 * 1024);
+
+    AppendHeader(out, "cs_connections_total", "counter", "Client connections accepted.");
+    AppendSample(out, "cs_connections_total", "", m.connectionsTotal.load(std::memory_order_relaxed));
+    AppendHeader(out, "cs_sessions_active", "gauge", "Connected client sessions.");
+    AppendSample(out, "cs_sessions_active", "", m.sessionsActive.load(std::memory_order_relaxed));
+    AppendHeader(out, "cs_transfers_active", "gauge", "Uploads and downloads in progress.");
+    AppendSample(out, "cs_transfers_active", "direction=\"upload\"",
+                 m.uploadsActive.load(std::memory_order_relaxed));
+    AppendSample(out, "cs_transfers_active", "direction=\"download\"",
+                 m.downloadsActive.load(std::memory_order_relaxed));
+
+    AppendHeader(out, "cs_io_queue_depth", "gauge", "File I/O tasks waiting for the IoPool.");
+    AppendSample(out, "cs_io_queue_depth", "", static_cast<uint64_t>(IoPool::Instance().pending()));
+    AppendHeader(out, "cs_log_dropped_total", "counter", "Log lines dropped because a log ring was full.");
+    AppendSample(out, "cs_log_dropped_total", "", util::Logger::dropped());
+
+    const ResponseCache& cache = router.cache();
+    AppendHeader(out, "cs_response_cache_lookups_total", "counter", "Response cache lookups, by result.");
+    AppendSample(out, "cs_response_cache_lookups_total", "result=\"hit\"", cache.hits());
+    AppendSample(out, "cs_response_cache_lookups_total", "result=\"miss\"", cache.misses());
+
+    const SharedReadGroup& reads = SharedReadGroup::Instance();
+    AppendHeader(out, "cs_file_reads_total", "counter",
+                 "Download chunk reads; joined reads shared an in-flight read.");
+    AppendSample(out, "cs_file_reads_total", "result=\"leader\"", reads.leaderReads());
+    AppendSample(out, "cs_file_reads_total", "result=\"joined\"", reads.joinedReads());
+
+    AppendCommandMetrics(out, router.stats());
+    return out;
+}
+
+} // namespace server
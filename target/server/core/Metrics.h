@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace server {
+
+class CommandRouter;
+
+// Process-wide counters and gauges that the request path bumps with relaxed
+// atomics. Read by RenderMetrics().
+struct ServerMetrics {
+    static ServerMetrics& Instance();
+
+    std::atomic<uint64_t> connectionsTotal{0};
+    std::atomic<int64_t> sessionsActive{0};
+    std::atomic<int64_t> uploadsActive{0};
+    std::atomic<int64_t> downloadsActive{0};
+};
+
+// Prometheus text exposition format 0.0.4. Only loads atomics, so a scrape
+// never blocks a request.
+std::string RenderMetrics(CommandRouter& router);
+
+} // namespace server
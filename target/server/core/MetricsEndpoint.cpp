@@ -0,0 +1,143 @@
+#include "MetricsEndpoint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <thread>
+
+#include <ws2tcpip.h>
+
+#include "../../common/net/FramedIO.h"
+#include "../../common/utils/Logger.h"
+#include "Metrics.h"
+
+namespace server {
+
+namespace {
+
+const size_t kMaxRequestBytes = 8 * 1024;
+const DWORD kRecvTimeoutMs = 2000;
+const DWORD kSendTimeoutMs = 2000;
+const int kAcceptBackoffMinMs = 10;
+const int kAcceptBackoffMaxMs = 1000;
+
+// accept() errors that clear up by themselves: out of descriptors or
+// buffers, or a client that gave up before it was accepted.
+bool IsTransientAcceptError(int err) {
+    return err == WSAEINTR || err == WSAEMFILE || err == WSAENOBUFS ||
+           err == WSAECONNRESET || err == WSAECONNABORTED;
+}
+
+void SendResponse(SOCKET s, const char* status, const char* contentType, const std::string& body) {
+    std::string out;
+    out.reserve(body.size() + 128);
+    out += "HTTP/1.0 ";
+    out += status;
+    out += "\r\nContent-Type: ";
+    out += contentType;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(body.size());
+    out += "\r\nConnection: close\r\n\r\n";
+    out += body;
+    net::sendAll(s, out.data(), out.size());
+}
+
+} // namespace
+
+bool MetricsEndpoint::Start(uint16_t port, std::string& err) {
+    SOCKET listenSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSock == INVALID_SOCKET) {
+        err = "socket() failed";
+        return false;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    InetPtonA(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (bind(listenSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+        err = "bind() failed for 127.0.0.1:" + std::to_string(port) +
+              " (error=" + std::to_string(WSAGetLastError()) + ")";
+        closesocket(listenSock);
+        return false;
+    }
+    if (listen(listenSock, 8) == SOCKET_ERROR) {
+        err = "listen() failed";
+        closesocket(listenSock);
+        return false;
+    }
+
+    std::thread([this, listenSock]() { Serve(listenSock); }).detach();
+    return true;
+}
+
+void MetricsEndpoint::Serve(SOCKET listenSock) {
+    int backoffMs = 0;
+    while (true) {
+        SOCKET s = accept(listenSock, nullptr, nullptr);
+        if (s == INVALID_SOCKET) {
+            const int err = WSAGetLastError();
+            if (!IsTransientAcceptError(err)) {
+                UTIL_LOG(Error) << "metrics accept() failed (error=" << err << "), endpoint stopped";
+                closesocket(listenSock);
+                return;
+            }
+            // Back off so a persistent condition (e.g. no descriptors left)
+            // does not spin this thread or flood the log.
+            backoffMs = backoffMs == 0 ? kAcceptBackoffMinMs : std::min(backoffMs * 2, kAcceptBackoffMaxMs);
+            UTIL_LOG(Warn) << "metrics accept() failed (error=" << err << "), retrying in " << backoffMs << " ms";
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+            continue;
+        }
+        backoffMs = 0;
+        HandleClient(s);
+        closesocket(s);
+    }
+}
+
+void MetricsEndpoint::HandleClient(SOCKET s) {
+    // A stalled scraper must not hold up the next one for long, whether it
+    // stops sending its request or stops reading the response.
+    const DWORD recvTimeout = kRecvTimeoutMs;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&recvTimeout), sizeof(recvTimeout));
+    const DWORD sendTimeout = kSendTimeoutMs;
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&sendTimeout), sizeof(sendTimeout));
+
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos) {
+        const int rc = recv(s, buf, static_cast<int>(sizeof(buf)), 0);
+        if (rc <= 0) {
+            return;
+        }
+        request.append(buf, static_cast<size_t>(rc));
+        if (request.size() > kMaxRequestBytes) {
+            SendResponse(s, "431 Request Header Fields Too Large", "text/plain", "request too large\n");
+            return;
+        }
+    }
+
+    // Request line: METHOD SP target SP version
+    const std::string_view line = std::string_view(request).substr(0, request.find_first_of("\r\n"));
+    const size_t sp1 = line.find(' ');
+    const size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos) {
+        SendResponse(s, "400 Bad Request", "text/plain", "bad request\n");
+        return;
+    }
+    const std::string_view method = line.substr(0, sp1);
+    std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    target = target.substr(0, target.find('?'));
+
+    if (target != "/metrics") {
+        SendResponse(s, "404 Not Found", "text/plain", "not found\n");
+        return;
+    }
+    if (method != "GET") {
+        SendResponse(s, "405 Method Not Allowed", "text/plain", "method not allowed\n");
+        return;
+    }
+    SendResponse(s, "200 OK", "text/plain; version=0.0.4; charset=utf-8", RenderMetrics(router_));
+}
+
+} // namespace server
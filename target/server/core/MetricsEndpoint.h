@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <winsock2.h>
+
+namespace server {
+
+class CommandRouter;
+
+// Minimal HTTP/1.0 listener for Prometheus scrapes. Binds to 127.0.0.1 only
+// and answers GET /metrics with RenderMetrics(); everything else gets 404.
+// Connections are served one at a time on the endpoint's own thread.
+class MetricsEndpoint {
+public:
+    explicit MetricsEndpoint(CommandRouter& router) : router_(router) {}
+
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    // Binds and starts the serving thread; the endpoint must outlive it.
+    bool Start(uint16_t port, std::string& err);
+
+private:
+    void Serve(SOCKET listenSock);
+    void HandleClient(SOCKET s);
+
+    CommandRouter& router_;
+};
+
+} // namespace server
@@ -0,0 +1,190 @@
+#include "ReadAhead.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "../../common/utils/Logger.h"
+#include "IoPool.h"
+
+namespace server {
+
+struct ReadAhead::Source {
+    std::string path;
+    std::mutex mutex;
+    std::ifstream stream;
+    std::atomic<uint64_t> avgReadUs{0};
+
+    Buffer Read(uint64_t offset, uint32_t length) {
+        return SharedReadGroup::Instance().Read(path, offset, length,
+            [this, offset, length](std::vector<uint8_t>& out) {
+                std::lock_guard<std::mutex> lock(mutex);
+                const auto start = std::chrono::steady_clock::now();
+                out.resize(length);
+                stream.clear();
+                stream.seekg(static_cast<std::streamoff>(offset));
+                stream.read(reinterpret_cast<char*>(out.data()),
+                            static_cast<std::streamsize>(out.size()));
+                const std::streamsize got = stream.gcount();
+                if (got < 0 || stream.bad()) {
+                    return false;
+                }
+                out.resize(static_cast<size_t>(got));
+
+                const auto us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+                const uint64_t prev = avgReadUs.load(std::memory_order_relaxed);
+                avgReadUs.store(prev == 0 ? us : (prev * 3 + us) / 4, std::memory_order_relaxed);
+                return true;
+            });
+    }
+
+    // A read that throws (a failed shared read, bad_alloc) is reported like
+    // any other read error, so the waiter in Take() is always resumed.
+    Buffer ReadOrNull(uint64_t offset, uint32_t length) {
+        try {
+            return Read(offset, length);
+        } catch (const std::exception& e) {
+            UTIL_LOG(Error) << "read-ahead of " << path << " failed: " << e.what();
+        } catch (...) {
+            UTIL_LOG(Error) << "read-ahead of " << path << " failed";
+        }
+        return nullptr;
+    }
+};
+
+// Result of one scheduled read. The coroutine taking it parks its handle
+// here when the read is still running; the pool task resumes it.
+struct ReadAhead::Slot {
+    std::mutex mutex;
+    bool ready = false;
+    Buffer buffer;
+    std::coroutine_handle<> waiter;
+    detail::WaitLoop* loop = nullptr;
+
+    void Set(Buffer value) {
+        std::coroutine_handle<> h;
+        detail::WaitLoop* target = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffer = std::move(value);
+            ready = true;
+            h = std::exchange(waiter, {});
+            target = loop;
+        }
+        if (h) {
+            detail::ResumeOn(target, h);
+        }
+    }
+};
+
+struct ReadAhead::SlotAwaiter {
+    std::shared_ptr<Slot> slot;
+
+    bool await_ready() const {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        return slot->ready;
+    }
+    bool await_suspend(std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        if (slot->ready) {
+            return false;
+        }
+        slot->waiter = h;
+        slot->loop = detail::CurrentWaitLoop();
+        return true;
+    }
+    Buffer await_resume() const {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        return slot->buffer;
+    }
+};
+
+ReadAhead::ReadAhead(const std::string& path, uint64_t fileSize, uint32_t chunkSize)
+    : source_(std::make_shared<Source>()),
+      fileSize_(fileSize),
+      chunkSize_(chunkSize) {
+    source_->path = path;
+    source_->stream.open(path, std::ios::binary);
+    if (source_->stream.is_open() && chunkSize_ > 0) {
+        Schedule(0);
+    }
+}
+
+bool ReadAhead::is_open() const {
+    return source_->stream.is_open();
+}
+
+uint32_t ReadAhead::chunkCount() const {
+    if (chunkSize_ == 0) {
+        return 0;
+    }
+    return static_cast<uint32_t>((fileSize_ + chunkSize_ - 1) / chunkSize_);
+}
+
+void ReadAhead::UpdateDepth() {
+    const auto now = std::chrono::steady_clock::now();
+    if (hasLastTake_) {
+        const auto gapUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            now - lastTake_).count());
+        avgGapUs_ = (avgGapUs_ == 0) ? gapUs : (avgGapUs_ * 3 + gapUs) / 4;
+    }
+    hasLastTake_ = true;
+    lastTake_ = now;
+
+    // Keep enough chunks in flight to cover one disk read per request interval.
+    const uint64_t readUs = source_->avgReadUs.load(std::memory_order_relaxed);
+    const uint64_t gapUs = std::max<uint64_t>(avgGapUs_, 1);
+    const uint64_t want = 1 + (readUs + gapUs - 1) / gapUs;
+    targetDepth_ = static_cast<size_t>(std::min<uint64_t>(want, kMaxDepth));
+}
+
+void ReadAhead::Schedule(uint32_t index) {
+    auto slot = std::make_shared<Slot>();
+    queue_.push_back(Pending{index, slot});
+
+    std::shared_ptr<Source> source = source_;
+    const uint64_t offset = static_cast<uint64_t>(index) * chunkSize_;
+    const uint32_t length = chunkSize_;
+    IoPool::Instance().Submit([source, slot, offset, length]() {
+        slot->Set(source->ReadOrNull(offset, length));
+    });
+}
+
+void ReadAhead::ScheduleAfter(uint32_t index) {
+    uint32_t next = queue_.empty() ? index + 1 : queue_.back().index + 1;
+    const uint32_t total = chunkCount();
+    while (queue_.size() < targetDepth_ && next < total) {
+        Schedule(next++);
+    }
+}
+
+Task<ReadAhead::Buffer> ReadAhead::Take(uint32_t index) {
+    UpdateDepth();
+
+    while (!queue_.empty() && queue_.front().index < index) {
+        queue_.pop_front();
+    }
+
+    if (!queue_.empty() && queue_.front().index == index) {
+        std::shared_ptr<Slot> slot = std::move(queue_.front().slot);
+        queue_.pop_front();
+        ScheduleAfter(index);
+        co_return co_await SlotAwaiter{std::move(slot)};
+    }
+
+    // Not queued, e.g. a download resumed past the prefetched chunks: read it
+    // on the pool as well, with the following chunks queued behind it.
+    queue_.clear();
+    ScheduleAfter(index);
+    std::shared_ptr<Source> source = source_;
+    const uint64_t offset = static_cast<uint64_t>(index) * chunkSize_;
+    const uint32_t length = chunkSize_;
+    co_return co_await RunOnIoPool([source, offset, length]() {
+        return source->ReadOrNull(offset, length);
+    });
+}
+
+} // namespace server
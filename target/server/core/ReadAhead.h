@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "SharedReadGroup.h"
+#include "Task.h"
+
+namespace server {
+
+// Sequential chunk reader for one download. While the client is busy with
+// chunk N, chunks N+1.. are read on the IoPool; the prefetch depth follows the
+// ratio of disk read time to the session's request interval.
+class ReadAhead {
+public:
+    using Buffer = SharedReadGroup::Buffer;
+
+    static constexpr size_t kMaxDepth = 8;
+
+    ReadAhead(const std::string& path, uint64_t fileSize, uint32_t chunkSize);
+
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    bool is_open() const;
+
+    // Yields the chunk at `index` (nullptr on read error) and schedules the
+    // following chunks. The caller is suspended, not blocked, until the read
+    // completes on the IoPool.
+    Task<Buffer> Take(uint32_t index);
+
+    size_t depth() const { return targetDepth_; }
+    size_t queued() const { return queue_.size(); }
+
+private:
+    struct Source;
+    struct Slot;
+    struct SlotAwaiter;
+
+    struct Pending {
+        uint32_t index = 0;
+        std::shared_ptr<Slot> slot;
+    };
+
+    uint32_t chunkCount() const;
+    void UpdateDepth();
+    void Schedule(uint32_t index);
+    void ScheduleAfter(uint32_t index);
+
+    std::shared_ptr<Source> source_;
+    uint64_t fileSize_ = 0;
+    uint32_t chunkSize_ = 0;
+    std::deque<Pending> queue_;
+
+    bool hasLastTake_ = false;
+    std::chrono::steady_clock::time_point lastTake_;
+    uint64_t avgGapUs_ = 0;
+    size_t targetDepth_ = 1;
+};
+
+} // namespace server
@@ -0,0 +1,27 @@
+#include "RequestContext.h"
+
+#include "../../common/net/FramedIO.h"
+
+namespace server {
+
+bool RequestContext::Decode() {
+    mark(Mark::Received);
+    ++seq;
+    req.cmd.clear();
+    req.args.fields.clear();
+    req.argsView = protocol::JsonView();
+    decodeErr = protocol::ErrorCode::Ok;
+    staticFrame = std::string_view();
+    cmd = CommandId::Count;
+    code = protocol::ErrorCode::Ok;
+    decoded = protocol::DecodeRequest(frame, doc, req, decodeErr);
+    mark(Mark::Decoded);
+    net::beginFrame(out);
+    return decoded;
+}
+
+int64_t RequestContext::elapsedUs(Mark from, Mark to) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(at(to) - at(from)).count();
+}
+
+} // namespace server
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "../../common/protocol/ErrorCode.h"
+#include "../../common/protocol/Message.h"
+#include "CommandTable.h"
+
+namespace server {
+
+// Per-connection state for one request/response round trip. The frame is
+// decoded once and the same message is used for logging, routing and the
+// handler; `out` collects the encoded response behind a reserved frame
+// header. Reused across requests so the buffers keep their capacity.
+struct RequestContext {
+    using Clock = std::chrono::steady_clock;
+
+    enum class Mark {
+        Received = 0,
+        Decoded,
+        Permitted,
+        Handled,
+        Encoded,
+        Sent,
+        Count
+    };
+
+    // Raw request payload; string args in `req.argsView` view into it.
+    std::string frame;
+    // Parse tree of `frame`; `req.argsView` points into it. Its arena is
+    // reused by the next request.
+    protocol::JsonDocument doc;
+    protocol::RequestMessage req;
+    bool decoded = false;
+    protocol::ErrorCode decodeErr = protocol::ErrorCode::Ok;
+    std::string out;
+    // When set, the complete frame to send instead of `out`.
+    std::string_view staticFrame;
+    // Filled in by CommandRouter::Handle; cmd is CommandId::Count for
+    // commands that are not built in or did not decode.
+    CommandId cmd = CommandId::Count;
+    protocol::ErrorCode code = protocol::ErrorCode::Ok;
+    // Connection id and per-connection request number, for tracing.
+    uint64_t connId = 0;
+    uint64_t seq = 0;
+    // When the frame header arrived; Received is stamped once the whole
+    // payload has been read.
+    Clock::time_point arrived{};
+
+    std::array<Clock::time_point, static_cast<size_t>(Mark::Count)> marks{};
+
+    // Call after `frame` has been filled: stamps Received, bumps seq,
+    // decodes, stamps Decoded and reserves the response frame header.
+    bool Decode();
+
+    void mark(Mark m) { marks[static_cast<size_t>(m)] = Clock::now(); }
+    Clock::time_point at(Mark m) const { return marks[static_cast<size_t>(m)]; }
+    int64_t elapsedUs(Mark from, Mark to) const;
+
+    size_t responseBytes() const { return staticFrame.empty() ? out.size() : staticFrame.size(); }
+};
+
+} // namespace server
@@ -0,0 +1,75 @@
+#include "ResponseCache.h"
+
+#include <mutex>
+
+namespace server {
+
+namespace {
+
+std::atomic<uint64_t> g_storageGeneration{0};
+
+} // namespace
+
+uint64_t StorageGeneration() {
+    return g_storageGeneration.load(std::memory_order_acquire);
+}
+
+void BumpStorageGeneration() {
+    g_storageGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void ResponseCache::Enable(CommandId id, Policy policy) {
+    Slot& slot = policies_[static_cast<size_t>(id)];
+    slot.enabled = true;
+    slot.policy = std::move(policy);
+}
+
+uint64_t ResponseCache::Generation(CommandId id) const {
+    const Slot& slot = policies_[static_cast<size_t>(id)];
+    return slot.policy.generation ? slot.policy.generation() : 0;
+}
+
+void ResponseCache::MakeKey(CommandId id, Session::Level level, const protocol::RequestMessage& req,
+                            std::string& key) const {
+    key.clear();
+    key.push_back(static_cast<char>(id));
+    key.push_back(static_cast<char>(static_cast<int>(level) + 1));
+    for (const auto& name : policies_[static_cast<size_t>(id)].policy.keyArgs) {
+        key.push_back('\0');
+        const protocol::JsonView v = req.argsView.find(name);
+        if (v.type() == protocol::JsonView::Type::String) {
+            key.push_back('s');
+            key += v.asString();
+        } else if (v.type() == protocol::JsonView::Type::Number) {
+            key.push_back('n');
+            key += std::to_string(v.asNumber());
+        }
+    }
+}
+
+bool ResponseCache::Lookup(CommandId id, const std::string& key, uint64_t generation, std::string& out) const {
+    const auto maxAge = policies_[static_cast<size_t>(id)].policy.maxAge;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.generation != generation ||
+        (maxAge.count() > 0 && Clock::now() - it->second.storedAt > maxAge)) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    out += it->second.json;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ResponseCache::Store(const std::string& key, uint64_t generation, std::string_view json) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Entry& e = entries_[key];
+    if (e.generation > generation && !e.json.empty()) {
+        return;
+    }
+    e.generation = generation;
+    e.storedAt = Clock::now();
+    e.json.assign(json.data(), json.size());
+}
+
+} // namespace server
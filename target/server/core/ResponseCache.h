@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../../common/protocol/Message.h"
+#include "CommandTable.h"
+#include "Session.h"
+
+namespace server {
+
+// Bumped whenever the set of files in storage_dir changes (upload commits).
+uint64_t StorageGeneration();
+void BumpStorageGeneration();
+
+// Serialized responses of idempotent commands, keyed by command, session
+// level and the command's key args. An entry is served only while its
+// command's generation is unchanged (and, if set, younger than maxAge), so
+// hits skip the handler and JSON serialization. Only successful responses
+// are stored.
+class ResponseCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Policy {
+        // Returns a value that changes whenever cached responses may be stale;
+        // empty means the responses never change while the server runs.
+        std::function<uint64_t()> generation;
+        // Args that distinguish responses (string or number values).
+        std::vector<std::string> keyArgs;
+        // Upper bound for changes no generation counter sees; zero disables.
+        std::chrono::milliseconds maxAge{0};
+    };
+
+    // Configure at startup, before requests are served.
+    void Enable(CommandId id, Policy policy);
+
+    bool enabled(CommandId id) const { return policies_[static_cast<size_t>(id)].enabled; }
+
+    // Read before running the handler, then passed to Store(), so a change
+    // that lands while the handler runs never gets tagged as current.
+    uint64_t Generation(CommandId id) const;
+
+    // Builds the lookup key into `key`.
+    void MakeKey(CommandId id, Session::Level level, const protocol::RequestMessage& req,
+                 std::string& key) const;
+
+    // Appends the cached JSON to `out` on a hit.
+    bool Lookup(CommandId id, const std::string& key, uint64_t generation, std::string& out) const;
+    void Store(const std::string& key, uint64_t generation, std::string_view json);
+
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        bool enabled = false;
+        Policy policy;
+    };
+
+    struct Entry {
+        uint64_t generation = 0;
+        Clock::time_point storedAt;
+        std::string json;
+    };
+
+    std::array<Slot, kCommandCount> policies_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    mutable std::atomic<uint64_t> hits_{0};
+    mutable std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace server
@@ -4,6 +4,7 @@
 #include <cstring>
 #include <fstream>
 #include <sstream>
+#include <utility>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -54,7 +55,7 @@ ConfigLoadResult LoadServerConfig(const std::string& path, ServerConfig& out, st
         return ConfigLoadResult::Invalid;
     }
 
-    protocol::JsonObject obj = *root.o;
+    const protocol::JsonObject& obj = *root.o;
 
     std::string bindIp;
     if (protocol::GetString(obj, "bind_ip", bindIp)) {
@@ -73,14 +74,14 @@ ConfigLoadResult LoadServerConfig(const std::string& path, ServerConfig& out, st
         }
         out.lowPassword = lowPassword;
     } else {
-        protocol::JsonArray lowUsersArr;
-        if (!protocol::GetArray(obj, "low_users", lowUsersArr) || lowUsersArr.items.empty()) {
+        const protocol::JsonArray* lowUsersArr = protocol::FindArray(obj, "low_users");
+        if (!lowUsersArr || lowUsersArr->items.empty()) {
             err = "invalid or missing field: low_password/low_users";
             return ConfigLoadResult::Invalid;
         }
         std::vector<ServerConfig::LowUser> lowUsers;
-        lowUsers.reserve(lowUsersArr.items.size());
-        for (const auto& item : lowUsersArr.items) {
+        lowUsers.reserve(lowUsersArr->items.size());
+        for (const auto& item : lowUsersArr->items) {
             if (item.type != protocol::JsonValue::Type::Object || !item.o) {
                 err = "invalid low_users item";
                 return ConfigLoadResult::Invalid;
@@ -160,6 +161,44 @@ ConfigLoadResult LoadServerConfig(const std::string& path, ServerConfig& out, st
         out.overwrite = overwrite;
     }
 
+    protocol::GetString(obj, "event_log", out.eventLogPath);
+
+    int64_t eventLogMb = 0;
+    if (protocol::GetNumber(obj, "event_log_file_mb", eventLogMb)) {
+        if (eventLogMb <= 0 || eventLogMb > 4096) {
+            err = "invalid field: event_log_file_mb";
+            return ConfigLoadResult::Invalid;
+        }
+        out.eventLogFileBytes = static_cast<uint64_t>(eventLogMb) * 1024 * 1024;
+    }
+
+    int64_t eventLogFiles = 0;
+    if (protocol::GetNumber(obj, "event_log_files", eventLogFiles)) {
+        if (eventLogFiles <= 0 || eventLogFiles > 100) {
+            err = "invalid field: event_log_files";
+            return ConfigLoadResult::Invalid;
+        }
+        out.eventLogFiles = static_cast<uint32_t>(eventLogFiles);
+    }
+
+    int64_t metricsPort = 0;
+    if (protocol::GetNumber(obj, "metrics_port", metricsPort)) {
+        if (metricsPort < 0 || metricsPort > 65535) {
+            err = "invalid field: metrics_port";
+            return ConfigLoadResult::Invalid;
+        }
+        out.metricsPort = static_cast<uint16_t>(metricsPort);
+    }
+
+    int64_t traceSample = 0;
+    if (protocol::GetNumber(obj, "trace_sample", traceSample)) {
+        if (traceSample < 0 || traceSample > 1000000) {
+            err = "invalid field: trace_sample";
+            return ConfigLoadResult::Invalid;
+        }
+        out.traceSample = static_cast<uint32_t>(traceSample);
+    }
+
     out.adminUser = adminUser;
     out.adminPassPlain = adminPass;
     out.desKeyHex = crypto::BytesToHex(keyBytes);
@@ -191,4 +230,40 @@ bool EnsureStorageDir(const std::string& path, std::string& err) {
     return false;
 }
 
+ConfigStore::ConfigStore(std::vector<std::string> paths)
+    : paths_(std::move(paths)),
+      current_(std::make_shared<const ServerConfig>(DefaultConfig())) {}
+
+ConfigStore::Snapshot ConfigStore::Get() const {
+    return current_.load();
+}
+
+ConfigLoadResult ConfigStore::Reload(std::string& err) {
+    std::lock_guard<std::mutex> lock(reloadMutex_);
+    for (const auto& path : paths_) {
+        auto next = std::make_shared<ServerConfig>();
+        const ConfigLoadResult result = LoadServerConfig(path, *next, err);
+        if (result == ConfigLoadResult::NotFound) {
+            continue;
+        }
+        if (result != ConfigLoadResult::Ok) {
+            return result;
+        }
+        if (!EnsureStorageDir(next->storageDir, err)) {
+            return ConfigLoadResult::Invalid;
+        }
+        source_ = path;
+        current_.store(Snapshot(std::move(next)));
+        generation_.fetch_add(1, std::memory_order_relaxed);
+        return ConfigLoadResult::Ok;
+    }
+    err = "no config file found";
+    return ConfigLoadResult::NotFound;
+}
+
+std::string ConfigStore::source() const {
+    std::lock_guard<std::mutex> lock(reloadMutex_);
+    return source_;
+}
+
 } // namespace server
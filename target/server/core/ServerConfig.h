@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -18,6 +21,18 @@ struct ServerConfig {
     uint32_t maxChunkBytes = 64 * 1024;
     std::string overwrite = "reject";
 
+    // Binary per-request event log; empty disables it. Read at startup only.
+    std::string eventLogPath;
+    uint64_t eventLogFileBytes = 64ull * 1024 * 1024;
+    uint32_t eventLogFiles = 4;
+
+    // Prometheus /metrics on 127.0.0.1; 0 disables it. Read at startup only.
+    uint16_t metricsPort = 0;
+
+    // Request tracing samples one request in N; 0 disables it. Read at
+    // startup; TRACE_DUMP can change it at runtime.
+    uint32_t traceSample = 0;
+
     struct LowUser {
         std::string username;
         std::string password;
@@ -34,4 +49,36 @@ enum class ConfigLoadResult {
 ConfigLoadResult LoadServerConfig(const std::string& path, ServerConfig& out, std::string& err);
 bool EnsureStorageDir(const std::string& path, std::string& err);
 
+// Holds the live configuration as an immutable snapshot. Handlers call Get()
+// once per request and keep using that snapshot; Reload() builds a new config
+// off to the side and publishes it with an atomic pointer swap, so requests
+// never wait on a reload and in-flight transfers are unaffected. bind_ip is
+// only read at startup; changing it still needs a restart.
+class ConfigStore {
+public:
+    using Snapshot = std::shared_ptr<const ServerConfig>;
+
+    // `paths` are tried in order, as at startup. Until the first successful
+    // Reload() the store holds the built-in defaults.
+    explicit ConfigStore(std::vector<std::string> paths);
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    Snapshot Get() const;
+
+    // On Invalid or NotFound the current snapshot stays in place.
+    ConfigLoadResult Reload(std::string& err);
+
+    std::string source() const;
+    uint64_t generation() const { return generation_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<std::string> paths_;
+    std::atomic<Snapshot> current_;
+    mutable std::mutex reloadMutex_;
+    std::string source_;
+    std::atomic<uint64_t> generation_{0};
+};
+
 } // namespace server
@@ -4,6 +4,11 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "Metrics.h"
+#include "ReadAhead.h"
+#include "ServerConfig.h"
 
 namespace server {
 
@@ -25,12 +30,27 @@ namespace server {
         uint32_t nextIndex = 0;
         uint32_t chunkSize = 0;
         std::unique_ptr<std::ofstream> stream;
+        // Config snapshot taken at UPLOAD_INIT, so a reload mid-transfer does
+        // not change limits or the target directory.
+        std::shared_ptr<const ServerConfig> config;
+        // Decoded chunk bytes, reused across chunks.
+        std::vector<uint8_t> writeBuffer;
+
+        // Clears any previous upload and marks a new one in progress.
+        void begin() {
+            reset();
+            inProgress = true;
+            ServerMetrics::Instance().uploadsActive.fetch_add(1, std::memory_order_relaxed);
+        }
 
         void reset() {
             if (stream) {
                 stream->close();
                 stream.reset();
             }
+            if (inProgress) {
+                ServerMetrics::Instance().uploadsActive.fetch_sub(1, std::memory_order_relaxed);
+            }
             inProgress = false;
             uploadId.clear();
             finalName.clear();
@@ -39,6 +59,7 @@ namespace server {
             receivedSize = 0;
             nextIndex = 0;
             chunkSize = 0;
+            config.reset();
         }
     };
 
@@ -50,12 +71,19 @@ namespace server {
         uint64_t fileSize = 0;
         uint32_t nextIndex = 0;
         uint32_t chunkSize = 0;
-        std::unique_ptr<std::ifstream> stream;
+        std::unique_ptr<ReadAhead> reader;
+
+        // Clears any previous download and marks a new one in progress.
+        void begin() {
+            reset();
+            inProgress = true;
+            ServerMetrics::Instance().downloadsActive.fetch_add(1, std::memory_order_relaxed);
+        }
 
         void reset() {
-            if (stream) {
-                stream->close();
-                stream.reset();
+            reader.reset();
+            if (inProgress) {
+                ServerMetrics::Instance().downloadsActive.fetch_sub(1, std::memory_order_relaxed);
             }
             inProgress = false;
             downloadId.clear();
@@ -0,0 +1,63 @@
+#include "SharedReadGroup.h"
+
+namespace server {
+
+SharedReadGroup& SharedReadGroup::Instance() {
+    static SharedReadGroup group;
+    return group;
+}
+
+SharedReadGroup::Buffer SharedReadGroup::Read(const std::string& path,
+                                              uint64_t offset,
+                                              uint32_t length,
+                                              const ReadFn& read) {
+    Key key{path, offset, length};
+    std::promise<Buffer> promise;
+    std::shared_future<Buffer> pending;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = inFlight_.find(key);
+        if (it != inFlight_.end()) {
+            pending = it->second;
+        } else {
+            pending = promise.get_future().share();
+            inFlight_.emplace(key, pending);
+            leader = true;
+        }
+    }
+
+    if (!leader) {
+        joined_.fetch_add(1, std::memory_order_relaxed);
+        return pending.get();
+    }
+    leaders_.fetch_add(1, std::memory_order_relaxed);
+
+    // Drops the entry however the read ends, so a throwing read cannot leave
+    // later readers joined to a promise nobody will fulfil.
+    struct EraseGuard {
+        SharedReadGroup& group;
+        const Key& key;
+        ~EraseGuard() {
+            std::lock_guard<std::mutex> lock(group.mutex_);
+            group.inFlight_.erase(key);
+        }
+    };
+
+    Buffer result;
+    try {
+        EraseGuard guard{*this, key};
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        if (read(*bytes)) {
+            result = std::move(bytes);
+        }
+    } catch (...) {
+        // Joiners rethrow the same exception from get().
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    promise.set_value(result);
+    return result;
+}
+
+} // namespace server
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace server {
+
+// Single-flight file reads: concurrent readers of the same (path, offset, length)
+// range join one in-flight read and share its reference-counted buffer.
+class SharedReadGroup {
+public:
+    using Buffer = std::shared_ptr<const std::vector<uint8_t>>;
+    // Fills the vector with at most `length` bytes; returns false on I/O error.
+    using ReadFn = std::function<bool(std::vector<uint8_t>&)>;
+
+    static SharedReadGroup& Instance();
+
+    // Returns nullptr if the leading read failed.
+    Buffer Read(const std::string& path, uint64_t offset, uint32_t length, const ReadFn& read);
+
+    uint64_t leaderReads() const { return leaders_.load(std::memory_order_relaxed); }
+    uint64_t joinedReads() const { return joined_.load(std::memory_order_relaxed); }
+
+private:
+    struct Key {
+        std::string path;
+        uint64_t offset = 0;
+        uint32_t length = 0;
+
+        bool operator<(const Key& other) const {
+            return std::tie(path, offset, length) < std::tie(other.path, other.offset, other.length);
+        }
+    };
+
+    std::mutex mutex_;
+    std::map<Key, std::shared_future<Buffer>> inFlight_;
+    std::atomic<uint64_t> leaders_{0};
+    std::atomic<uint64_t> joined_{0};
+};
+
+} // namespace server
@@ -0,0 +1,62 @@
+#include "StaticReplies.h"
+
+#include <array>
+#include <string>
+
+#include "../../common/net/FramedIO.h"
+
+namespace server {
+
+namespace {
+
+struct Canned {
+    bool ok;
+    protocol::ErrorCode code;
+    const char* msg;
+};
+
+constexpr size_t kReplyCount = static_cast<size_t>(StaticReply::Count);
+
+// Indexed by StaticReply.
+constexpr std::array<Canned, kReplyCount> kCanned = {{
+    {true, protocol::ErrorCode::Ok, ""},
+    {true, protocol::ErrorCode::Ok, "pong"},
+    {true, protocol::ErrorCode::Ok, "admin_pong"},
+    {false, protocol::ErrorCode::BadRequest, "bad request"},
+    {false, protocol::ErrorCode::UnknownCmd, "unknown cmd"},
+    {false, protocol::ErrorCode::NotLogin, "not login"},
+    {false, protocol::ErrorCode::NotLogin, "need low login"},
+    {false, protocol::ErrorCode::NoPermission, "no permission"},
+    {false, protocol::ErrorCode::InternalError, "response too large"},
+}};
+
+std::array<std::string, kReplyCount> g_frames;
+
+} // namespace
+
+// Encoded with AppendResponse, so the bytes match a dynamically built reply.
+void BuildStaticReplies() {
+    for (size_t i = 1; i < kReplyCount; ++i) {
+        protocol::ResponseMessage resp;
+        FillStaticReply(static_cast<StaticReply>(i), resp);
+        std::string& frame = g_frames[i];
+        frame.clear();
+        net::beginFrame(frame);
+        protocol::AppendResponse(resp, frame);
+        net::finishFrame(frame);
+    }
+}
+
+void FillStaticReply(StaticReply reply, protocol::ResponseMessage& resp) {
+    const Canned& c = kCanned[static_cast<size_t>(reply)];
+    resp.ok = c.ok;
+    resp.code = c.code;
+    resp.msg = c.msg;
+    resp.data.fields.clear();
+}
+
+std::string_view StaticReplyFrame(StaticReply reply) {
+    return g_frames[static_cast<size_t>(reply)];
+}
+
+} // namespace server
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "../../common/protocol/Message.h"
+
+namespace server {
+
+// Responses whose bytes never change: trivial command replies and the fixed
+// routing errors. Each one is serialized once, frame header included, and
+// sent straight from that buffer.
+enum class StaticReply : uint8_t {
+    None = 0,
+    Pong,
+    AdminPong,
+    BadRequest,
+    UnknownCmd,
+    NotLogin,
+    NeedLowLogin,
+    NoPermission,
+    ResponseTooLarge,
+    Count
+};
+
+// Sets ok/code/msg and clears data, for callers that need the message form
+// (e.g. BATCH sub-results).
+void FillStaticReply(StaticReply reply, protocol::ResponseMessage& resp);
+
+// Serializes every frame. Call once at startup, before any request is
+// handled; StaticReplyFrame() then only indexes a table.
+void BuildStaticReplies();
+
+// Length prefix plus JSON; valid for the life of the process.
+std::string_view StaticReplyFrame(StaticReply reply);
+
+} // namespace server
@@ -0,0 +1,207 @@
+#include "Stats.h"
+
+namespace server {
+
+namespace {
+
+int HighestBit(uint64_t v) {
+    int bit = 0;
+    while (v >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+size_t CodeIndex(protocol::ErrorCode code) {
+    for (size_t i = 0; i < CommandStats::kTrackedCodes.size(); ++i) {
+        if (CommandStats::kTrackedCodes[i] == code) {
+            return i;
+        }
+    }
+    return CommandStats::kTrackedCodes.size() - 1;
+}
+
+uint64_t Minus(uint64_t v, uint64_t base) {
+    return v > base ? v - base : 0;
+}
+
+void RaiseMax(std::atomic<uint64_t>& max, uint64_t us) {
+    uint64_t prev = max.load(std::memory_order_relaxed);
+    while (us > prev && !max.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t PhaseUs(const RequestContext& ctx, RequestContext::Mark from, RequestContext::Mark to) {
+    const int64_t us = ctx.elapsedUs(from, to);
+    return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
+
+} // namespace
+
+size_t LatencyHistogram::BucketOf(uint64_t us) {
+    if (us < kSubBuckets) {
+        return static_cast<size_t>(us);
+    }
+    const int bit = HighestBit(us);
+    if (bit >= 32) {
+        return kBuckets - 1;
+    }
+    const int shift = bit - 4;
+    const size_t sub = static_cast<size_t>(us >> shift) - kSubBuckets;
+    return kSubBuckets + static_cast<size_t>(shift) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketHigh(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    const size_t shift = (bucket - kSubBuckets) / kSubBuckets;
+    const uint64_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t us) {
+    buckets_[BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(us, std::memory_order_relaxed);
+    RaiseMax(max_, us);
+    RaiseMax(windowMax_, us);
+}
+
+void LatencyHistogram::Load(Snapshot& out) const {
+    out.count = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        out.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        out.count += out.buckets[i];
+    }
+    out.sum = sum_.load(std::memory_order_relaxed);
+    out.max = max_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Snapshot::Percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    // Rank of the sample at quantile q, 1-based.
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count) + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            const uint64_t high = BucketHigh(i);
+            return high < max ? high : max;
+        }
+    }
+    return max;
+}
+
+const char* CommandStats::PhaseName(Phase phase) {
+    switch (phase) {
+    case Phase::Decode:
+        return "decode";
+    case Phase::Permission:
+        return "permission";
+    case Phase::Handler:
+        return "handler";
+    case Phase::Encode:
+        return "encode";
+    case Phase::Send:
+        return "send";
+    case Phase::Total:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
+
+const char* CommandStats::SlotName(size_t slot) {
+    return slot < kCommandCount ? kCommandNames[slot].data() : "OTHER";
+}
+
+CommandStats::CommandStats() {
+    since_.fill(std::chrono::steady_clock::now());
+}
+
+void CommandStats::Record(const RequestContext& ctx) {
+    using Mark = RequestContext::Mark;
+    Slot& s = slots_[static_cast<size_t>(ctx.cmd)];
+    s.count.fetch_add(1, std::memory_order_relaxed);
+    if (ctx.code != protocol::ErrorCode::Ok) {
+        s.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    s.codes[CodeIndex(ctx.code)].fetch_add(1, std::memory_order_relaxed);
+    s.bytesIn.fetch_add(ctx.frame.size(), std::memory_order_relaxed);
+    s.bytesOut.fetch_add(ctx.responseBytes(), std::memory_order_relaxed);
+
+    s.phases[static_cast<size_t>(Phase::Decode)].Record(PhaseUs(ctx, Mark::Received, Mark::Decoded));
+    s.phases[static_cast<size_t>(Phase::Permission)].Record(PhaseUs(ctx, Mark::Decoded, Mark::Permitted));
+    s.phases[static_cast<size_t>(Phase::Handler)].Record(PhaseUs(ctx, Mark::Permitted, Mark::Handled));
+    s.phases[static_cast<size_t>(Phase::Encode)].Record(PhaseUs(ctx, Mark::Handled, Mark::Encoded));
+    s.phases[static_cast<size_t>(Phase::Send)].Record(PhaseUs(ctx, Mark::Encoded, Mark::Sent));
+    s.phases[static_cast<size_t>(Phase::Total)].Record(PhaseUs(ctx, Mark::Received, Mark::Sent));
+}
+
+void CommandStats::LoadTotal(size_t slot, Snapshot& out) const {
+    const Slot& s = slots_[slot];
+    out.count = s.count.load(std::memory_order_relaxed);
+    out.errors = s.errors.load(std::memory_order_relaxed);
+    out.bytesIn = s.bytesIn.load(std::memory_order_relaxed);
+    out.bytesOut = s.bytesOut.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < out.codes.size(); ++i) {
+        out.codes[i] = s.codes[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < kPhaseCount; ++i) {
+        s.phases[i].Load(out.phases[i]);
+    }
+}
+
+void CommandStats::Load(size_t slot, Snapshot& out) const {
+    LoadTotal(slot, out);
+    std::lock_guard<std::mutex> lock(baselineMutex_);
+    const Snapshot& base = baseline_[slot];
+    out.count = Minus(out.count, base.count);
+    out.errors = Minus(out.errors, base.errors);
+    out.bytesIn = Minus(out.bytesIn, base.bytesIn);
+    out.bytesOut = Minus(out.bytesOut, base.bytesOut);
+    for (size_t i = 0; i < out.codes.size(); ++i) {
+        out.codes[i] = Minus(out.codes[i], base.codes[i]);
+    }
+    for (size_t p = 0; p < kPhaseCount; ++p) {
+        LatencyHistogram::Snapshot& h = out.phases[p];
+        const LatencyHistogram::Snapshot& b = base.phases[p];
+        h.count = 0;
+        for (size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+            h.buckets[i] = Minus(h.buckets[i], b.buckets[i]);
+            h.count += h.buckets[i];
+        }
+        h.sum = Minus(h.sum, b.sum);
+        h.max = slots_[slot].phases[p].windowMax();
+    }
+}
+
+uint64_t CommandStats::count(size_t slot) const {
+    const uint64_t total = totalCount(slot);
+    std::lock_guard<std::mutex> lock(baselineMutex_);
+    return Minus(total, baseline_[slot].count);
+}
+
+void CommandStats::Reset(size_t first, size_t last) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(baselineMutex_);
+    for (size_t slot = first; slot < last && slot < kSlots; ++slot) {
+        LoadTotal(slot, baseline_[slot]);
+        for (auto& h : slots_[slot].phases) {
+            h.RestartWindow();
+        }
+        since_[slot] = now;
+    }
+}
+
+std::chrono::steady_clock::time_point CommandStats::since(size_t slot) const {
+    std::lock_guard<std::mutex> lock(baselineMutex_);
+    return since_[slot];
+}
+
+} // namespace server
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "../../common/protocol/ErrorCode.h"
+#include "CommandTable.h"
+#include "RequestContext.h"
+
+namespace server {
+
+// Log-linear latency histogram in microseconds, HDR style: 16 linear
+// sub-buckets per power of two, so any recorded value is reported within
+// ~6%. Recording is a few relaxed atomic adds; readers never block writers.
+class LatencyHistogram {
+public:
+    static constexpr size_t kSubBuckets = 16;
+    // Values up to 2^32 us (~71 minutes); larger ones land in the last bucket.
+    static constexpr size_t kBuckets = kSubBuckets + (32 - 4) * kSubBuckets;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::array<uint64_t, kBuckets> buckets{};
+
+        // q in [0, 1]; returns the upper edge of the bucket holding it.
+        uint64_t Percentile(double q) const;
+        uint64_t Mean() const { return count ? sum / count : 0; }
+    };
+
+    void Record(uint64_t us);
+    // Everything recorded since startup; `max` is the all-time largest value.
+    void Load(Snapshot& out) const;
+
+    // Largest value since the last RestartWindow().
+    uint64_t windowMax() const { return windowMax_.load(std::memory_order_relaxed); }
+    void RestartWindow() { windowMax_.store(0, std::memory_order_relaxed); }
+
+    static size_t BucketOf(uint64_t us);
+    static uint64_t BucketHigh(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+    std::atomic<uint64_t> windowMax_{0};
+};
+
+// Per-command request counters and phase latencies, recorded by
+// CommandRouter::Complete() once a response has been sent. The counters
+// only ever grow, so Prometheus can treat them as counters; Reset() starts a
+// new window for STATS by remembering a baseline instead of zeroing them.
+class CommandStats {
+public:
+    enum class Phase {
+        Decode = 0,   // Received -> Decoded
+        Permission,   // Decoded -> Permitted (interceptor Before hooks)
+        Handler,      // Permitted -> Handled
+        Encode,       // Handled -> Encoded
+        Send,         // Encoded -> Sent
+        Total,        // Received -> Sent
+        Count
+    };
+    static constexpr size_t kPhaseCount = static_cast<size_t>(Phase::Count);
+
+    // Slot kCommandCount collects runtime-registered and unknown commands.
+    static constexpr size_t kSlots = kCommandCount + 1;
+
+    // Error codes with their own counters; codes not listed count as
+    // InternalError.
+    static constexpr std::array<protocol::ErrorCode, 11> kTrackedCodes = {
+        protocol::ErrorCode::Ok,
+        protocol::ErrorCode::BadRequest,
+        protocol::ErrorCode::UnknownCmd,
+        protocol::ErrorCode::NotLogin,
+        protocol::ErrorCode::NoPermission,
+        protocol::ErrorCode::FileExists,
+        protocol::ErrorCode::FileNotFound,
+        protocol::ErrorCode::TransferStateError,
+        protocol::ErrorCode::SizeMismatch,
+        protocol::ErrorCode::ChecksumMismatch,
+        protocol::ErrorCode::InternalError,
+    };
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t errors = 0;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        std::array<uint64_t, kTrackedCodes.size()> codes{};
+        std::array<LatencyHistogram::Snapshot, kPhaseCount> phases;
+    };
+
+    static const char* PhaseName(Phase phase);
+    static const char* SlotName(size_t slot);
+
+    CommandStats();
+
+    void Record(const RequestContext& ctx);
+
+    // Totals since the last Reset(); latency `max` is the window's largest.
+    void Load(size_t slot, Snapshot& out) const;
+    uint64_t count(size_t slot) const;
+
+    // Totals since startup, untouched by Reset().
+    void LoadTotal(size_t slot, Snapshot& out) const;
+    uint64_t totalCount(size_t slot) const { return slots_[slot].count.load(std::memory_order_relaxed); }
+
+    // Starts a new window for Load() and count() of slots [first, last);
+    // other slots keep theirs. A request recorded while it runs may be split
+    // between the old and the new window.
+    void Reset(size_t first = 0, size_t last = kSlots);
+    // Start of `slot`'s current window.
+    std::chrono::steady_clock::time_point since(size_t slot) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> bytesIn{0};
+        std::atomic<uint64_t> bytesOut{0};
+        std::array<std::atomic<uint64_t>, kTrackedCodes.size()> codes{};
+        std::array<LatencyHistogram, kPhaseCount> phases;
+    };
+
+    std::array<Slot, kSlots> slots_;
+    mutable std::mutex baselineMutex_;
+    std::array<Snapshot, kSlots> baseline_;
+    std::array<std::chrono::steady_clock::time_point, kSlots> since_;
+};
+
+} // namespace server
@@ -0,0 +1,96 @@
+#include "Task.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace server {
+
+namespace detail {
+
+struct WaitLoop {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::coroutine_handle<>> ready;
+    bool done = false;
+    std::exception_ptr error;
+};
+
+namespace {
+
+thread_local WaitLoop* t_loop = nullptr;
+
+} // namespace
+
+WaitLoop* CurrentWaitLoop() {
+    return t_loop;
+}
+
+void ResumeOn(WaitLoop* loop, std::coroutine_handle<> h) {
+    if (!loop) {
+        h.resume();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(loop->mutex);
+    loop->ready.push_back(h);
+    loop->cv.notify_one();
+}
+
+} // namespace detail
+
+namespace {
+
+// Eagerly started, self-destroying driver: awaits the task, then wakes the
+// waiting thread. Arguments are copied into the coroutine frame, so nothing
+// dangles while it is suspended.
+struct SyncWaitDriver {
+    struct promise_type {
+        SyncWaitDriver get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+SyncWaitDriver RunSyncWait(Task<void>* task, detail::WaitLoop* loop) {
+    try {
+        co_await *task;
+    } catch (...) {
+        loop->error = std::current_exception();
+    }
+    // Notify under the lock: the waiter owns `loop` and may destroy it as
+    // soon as it observes `done`.
+    std::lock_guard<std::mutex> lock(loop->mutex);
+    loop->done = true;
+    loop->cv.notify_one();
+}
+
+} // namespace
+
+void SyncWait(Task<void> task) {
+    detail::WaitLoop loop;
+    detail::WaitLoop* const outer = std::exchange(detail::t_loop, &loop);
+    RunSyncWait(&task, &loop);
+
+    std::unique_lock<std::mutex> lock(loop.mutex);
+    while (true) {
+        loop.cv.wait(lock, [&loop]() { return loop.done || !loop.ready.empty(); });
+        if (loop.ready.empty()) {
+            break;
+        }
+        const std::coroutine_handle<> h = loop.ready.front();
+        loop.ready.pop_front();
+        lock.unlock();
+        h.resume();
+        lock.lock();
+    }
+    lock.unlock();
+
+    detail::t_loop = outer;
+    if (loop.error) {
+        std::rethrow_exception(loop.error);
+    }
+}
+
+} // namespace server
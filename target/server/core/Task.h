@@ -0,0 +1,192 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "IoPool.h"
+
+namespace server {
+
+// Lazily started coroutine returning T. A Task runs when it is co_awaited
+// (or handed to SyncWait) and resumes its awaiter when it finishes;
+// exceptions propagate to the awaiter.
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& v) {
+        value.emplace(std::forward<U>(v));
+    }
+
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() const noexcept {}
+
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Task(Handle h) : handle_(h) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+template <typename F>
+using OffloadResult = std::invoke_result_t<F&>;
+
+// The SyncWait call driving the calling thread's coroutine, or nullptr.
+struct WaitLoop;
+WaitLoop* CurrentWaitLoop();
+
+// Continues `h` on the thread blocked in `loop`'s SyncWait, so a handler
+// keeps its thread-local state (e.g. tracing) across a suspension. Resumes
+// inline when `loop` is nullptr.
+void ResumeOn(WaitLoop* loop, std::coroutine_handle<> h);
+
+} // namespace detail
+
+// Runs `fn` on the IoPool, then resumes the awaiting coroutine with its
+// result on the thread that awaited it (see detail::ResumeOn). The pool
+// thread is held only for `fn` itself.
+template <typename F>
+class OffloadAwaiter {
+public:
+    using Result = detail::OffloadResult<F>;
+
+    explicit OffloadAwaiter(F fn) : fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        detail::WaitLoop* loop = detail::CurrentWaitLoop();
+        IoPool::Instance().Submit([this, h, loop]() {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    fn_();
+                    result_.template emplace<1>();
+                } else {
+                    result_.template emplace<1>(fn_());
+                }
+            } catch (...) {
+                result_.template emplace<2>(std::current_exception());
+            }
+            detail::ResumeOn(loop, h);
+        });
+    }
+
+    Result await_resume() {
+        if (result_.index() == 2) {
+            std::rethrow_exception(std::get<2>(result_));
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(std::get<1>(result_));
+        }
+    }
+
+private:
+    using Stored = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+    F fn_;
+    std::variant<std::monostate, Stored, std::exception_ptr> result_;
+};
+
+template <typename F>
+OffloadAwaiter<F> RunOnIoPool(F fn) {
+    return OffloadAwaiter<F>(std::move(fn));
+}
+
+// Blocks the calling thread until `task` completes; rethrows its exception.
+// This is the bridge from the synchronous session loop into coroutine
+// handlers: the task runs on the calling thread, and whenever it resumes
+// from an awaiter that completed elsewhere it resumes here again.
+void SyncWait(Task<void> task);
+
+} // namespace server
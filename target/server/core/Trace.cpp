@@ -0,0 +1,235 @@
+#include "Trace.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "../../common/protocol/JsonLite.h"
+
+namespace server {
+
+namespace {
+
+constexpr const char kCatStage[] = "stage";
+constexpr const char kCatRequest[] = "request";
+constexpr const char kCatHandler[] = "handler";
+
+// xorshift64; seeded per thread so sampling needs no shared state.
+uint64_t NextRandom() {
+    thread_local uint64_t state = [] {
+        uint64_t seed = static_cast<uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        seed ^= reinterpret_cast<uintptr_t>(&seed);
+        return seed ? seed : 0x9E3779B97F4A7C15ull;
+    }();
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+void AppendKey(std::string& out, const char* key, int64_t v) {
+    out += '"';
+    out += key;
+    out += "\":";
+    protocol::AppendJsonNumber(v, out);
+}
+
+} // namespace
+
+struct Tracer::BufferHandle {
+    std::shared_ptr<Buffer> buffer;
+    ~BufferHandle() {
+        if (buffer) {
+            buffer->retired.store(true, std::memory_order_relaxed);
+        }
+    }
+};
+
+Tracer& Tracer::Instance() {
+    // Leaked so session threads still running at exit never see it destroyed.
+    static Tracer* tracer = new Tracer();
+    return *tracer;
+}
+
+Tracer::Tracer() : epoch_(Clock::now()) {}
+
+void Tracer::BeginRequest(const RequestContext& ctx) {
+    const uint32_t every = sampleEvery();
+    t_active = every != 0 && (every == 1 || NextRandom() % every == 0);
+    if (t_active) {
+        t_connId = ctx.connId;
+        t_seq = ctx.seq;
+    }
+}
+
+void Tracer::EndRequest(const RequestContext& ctx) {
+    if (!t_active) {
+        return;
+    }
+    t_active = false;
+
+    using Mark = RequestContext::Mark;
+    const Clock::time_point begin =
+        (ctx.arrived != Clock::time_point{}) ? ctx.arrived : ctx.at(Mark::Received);
+
+    Span span;
+    span.connId = t_connId;
+    span.seq = t_seq;
+    span.cat = kCatStage;
+    auto stage = [&](const char* name, Clock::time_point from, Clock::time_point to) {
+        span.name = name;
+        span.startUs = SinceEpochUs(from);
+        span.durUs = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+        Push(span);
+    };
+    if (begin != ctx.at(Mark::Received)) {
+        stage("recvFrame", begin, ctx.at(Mark::Received));
+    }
+    stage("decode", ctx.at(Mark::Received), ctx.at(Mark::Decoded));
+    stage("permission", ctx.at(Mark::Decoded), ctx.at(Mark::Permitted));
+    stage("handler", ctx.at(Mark::Permitted), ctx.at(Mark::Handled));
+    stage("encode", ctx.at(Mark::Handled), ctx.at(Mark::Encoded));
+    stage("sendFrame", ctx.at(Mark::Encoded), ctx.at(Mark::Sent));
+
+    span.cat = kCatRequest;
+    span.code = ctx.code;
+    span.bytesIn = ctx.frame.size();
+    span.bytesOut = ctx.responseBytes();
+    stage(ctx.cmd == CommandId::Count ? "request" : kCommandNames[static_cast<size_t>(ctx.cmd)].data(),
+          begin, ctx.at(Mark::Sent));
+}
+
+void Tracer::Record(const char* name, Clock::time_point start, Clock::time_point end, uint64_t bytes) {
+    Span span;
+    span.name = name;
+    span.cat = kCatHandler;
+    span.startUs = SinceEpochUs(start);
+    span.durUs = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    span.connId = t_connId;
+    span.seq = t_seq;
+    span.bytesIn = bytes;
+    Push(span);
+}
+
+Tracer::Buffer& Tracer::LocalBuffer() {
+    thread_local BufferHandle handle;
+    if (!handle.buffer) {
+        auto buffer = std::make_shared<Buffer>();
+        buffer->tid = nextTid_.fetch_add(1, std::memory_order_relaxed);
+        buffer->spans.resize(kSpansPerThread);
+
+        std::lock_guard<std::mutex> lock(mu_);
+        size_t retired = 0;
+        for (const auto& b : buffers_) {
+            retired += b->retired.load(std::memory_order_relaxed) ? 1 : 0;
+        }
+        for (auto it = buffers_.begin(); it != buffers_.end() && retired >= kMaxRetiredBuffers;) {
+            if ((*it)->retired.load(std::memory_order_relaxed)) {
+                it = buffers_.erase(it);
+                --retired;
+            } else {
+                ++it;
+            }
+        }
+        buffers_.push_back(buffer);
+        handle.buffer = std::move(buffer);
+    }
+    return *handle.buffer;
+}
+
+void Tracer::Push(const Span& span) {
+    Buffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mu);
+    buffer.spans[buffer.next] = span;
+    if (++buffer.next == buffer.spans.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+int64_t Tracer::SinceEpochUs(Clock::time_point t) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - epoch_).count();
+}
+
+size_t Tracer::Dump(std::string& out, bool clear) {
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        buffers = buffers_;
+        if (clear) {
+            std::erase_if(buffers_, [](const std::shared_ptr<Buffer>& b) {
+                return b->retired.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    size_t written = 0;
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"server\"}}";
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mu);
+        const size_t count = buffer->wrapped ? buffer->spans.size() : buffer->next;
+        const size_t first = buffer->wrapped ? buffer->next : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const Span& s = buffer->spans[(first + i) % buffer->spans.size()];
+            out += ",{\"name\":\"";
+            protocol::JsonEscapeAppend(s.name, out);
+            out += "\",\"cat\":\"";
+            out += s.cat;
+            out += "\",\"ph\":\"X\",";
+            AppendKey(out, "ts", s.startUs);
+            out += ',';
+            AppendKey(out, "dur", s.durUs);
+            out += ",\"pid\":1,";
+            AppendKey(out, "tid", buffer->tid);
+            out += ",\"args\":{";
+            AppendKey(out, "conn", static_cast<int64_t>(s.connId));
+            out += ',';
+            AppendKey(out, "req", static_cast<int64_t>(s.seq));
+            if (s.cat == kCatRequest) {
+                out += ',';
+                AppendKey(out, "code", protocol::ErrorCodeToInt(s.code));
+                out += ',';
+                AppendKey(out, "bytes_in", static_cast<int64_t>(s.bytesIn));
+                out += ',';
+                AppendKey(out, "bytes_out", static_cast<int64_t>(s.bytesOut));
+            } else if (s.bytesIn != 0) {
+                out += ',';
+                AppendKey(out, "bytes", static_cast<int64_t>(s.bytesIn));
+            }
+            out += "}}";
+        }
+        written += count;
+        if (clear) {
+            buffer->next = 0;
+            buffer->wrapped = false;
+        }
+    }
+    out += "]}\n";
+    return written;
+}
+
+bool DumpTraceFile(const std::string& dir, bool clear,
+                   std::string& fileName, size_t& spans, std::string& err) {
+    const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    fileName = "trace_" + std::to_string(nowMs) + ".json";
+
+    std::string json;
+    spans = Tracer::Instance().Dump(json, clear);
+
+    const std::filesystem::path path = std::filesystem::path(dir) / fileName;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        err = "cannot open " + path.string();
+        return false;
+    }
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    if (!file) {
+        err = "write failed: " + path.string();
+        return false;
+    }
+    return true;
+}
+
+} // namespace server
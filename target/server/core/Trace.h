@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "RequestContext.h"
+
+namespace server {
+
+// Sampled request tracing. For one request in `sampleEvery()`, the stages
+// of the round trip (recvFrame, decode, permission, handler, encode,
+// sendFrame) and any TraceSpan opened inside the handler are recorded into
+// a per-thread ring buffer. Dump() writes every buffered span as Chrome
+// trace JSON, which chrome://tracing and Perfetto load directly.
+//
+// Unsampled requests cost one thread-local check per span site plus one
+// random draw per request, so tracing can stay on in production.
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Spans kept per thread; older ones are overwritten.
+    static constexpr size_t kSpansPerThread = 4096;
+    // Buffers of exited threads kept for the next dump.
+    static constexpr size_t kMaxRetiredBuffers = 64;
+
+    static Tracer& Instance();
+
+    // 0 disables tracing; N samples one request in N on average.
+    void setSampleEvery(uint32_t n) { sampleEvery_.store(n, std::memory_order_relaxed); }
+    uint32_t sampleEvery() const { return sampleEvery_.load(std::memory_order_relaxed); }
+
+    // Called by CommandRouter around each request on the session thread.
+    void BeginRequest(const RequestContext& ctx);
+    void EndRequest(const RequestContext& ctx);
+
+    // True while the calling thread is inside a sampled request.
+    static bool active() { return t_active; }
+
+    // Records a span for the calling thread's sampled request. `name` must
+    // be a string literal; `bytes` is reported in the span's args when set.
+    void Record(const char* name, Clock::time_point start, Clock::time_point end, uint64_t bytes);
+
+    // Appends {"traceEvents":[...]} for all buffered spans and returns the
+    // number of spans written. `clear` empties the buffers afterwards.
+    size_t Dump(std::string& out, bool clear);
+
+private:
+    struct Span {
+        const char* name = nullptr;
+        const char* cat = nullptr;
+        int64_t startUs = 0;
+        int64_t durUs = 0;
+        uint64_t connId = 0;
+        uint64_t seq = 0;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        protocol::ErrorCode code = protocol::ErrorCode::Ok;
+    };
+
+    struct Buffer {
+        std::mutex mu;
+        uint32_t tid = 0;
+        std::vector<Span> spans;
+        size_t next = 0;
+        bool wrapped = false;
+        std::atomic<bool> retired{false};
+    };
+    struct BufferHandle;
+
+    Tracer();
+
+    Buffer& LocalBuffer();
+    void Push(const Span& span);
+    int64_t SinceEpochUs(Clock::time_point t) const;
+
+    static inline thread_local bool t_active = false;
+    static inline thread_local uint64_t t_connId = 0;
+    static inline thread_local uint64_t t_seq = 0;
+
+    const Clock::time_point epoch_;
+    std::atomic<uint32_t> sampleEvery_{0};
+    std::atomic<uint32_t> nextTid_{1};
+    std::mutex mu_;
+    std::vector<std::shared_ptr<Buffer>> buffers_;
+};
+
+// Records a span from construction to end() or destruction when the calling
+// thread is inside a sampled request; otherwise does nothing.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : name_(Tracer::active() ? name : nullptr) {
+        if (name_) {
+            start_ = Tracer::Clock::now();
+        }
+    }
+    ~TraceSpan() { end(); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void end(uint64_t bytes = 0) {
+        if (name_) {
+            Tracer::Instance().Record(name_, start_, Tracer::Clock::now(), bytes);
+            name_ = nullptr;
+        }
+    }
+
+private:
+    const char* name_;
+    Tracer::Clock::time_point start_;
+};
+
+// Dumps the trace into `dir` as trace_<unix ms>.json. Returns false with
+// `err` set when the file cannot be written.
+bool DumpTraceFile(const std::string& dir, bool clear,
+                   std::string& fileName, size_t& spans, std::string& err);
+
+} // namespace server
@@ -1,7 +1,12 @@
 #include "AdminHandlers.h"
 #include <windows.h>        // 提供 WinExec, SW_HIDE, UINT 等
+#include <chrono>
 #include <string>
 
+#include "../../common/utils/Logger.h"
+#include "../core/ResponseCache.h"
+#include "../core/Trace.h"
+
 // 👇 关键：确保 WIN32_LEAN_AND_MEAN 被正确定义（可选但推荐）
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -9,19 +14,61 @@
 
 namespace server {
 
-void RegisterAdminHandlers(CommandRouter& router) {
-    router.RegisterCommand("ADMIN_PING", Session::Level::High,
-        [](const protocol::RequestMessage&, Session&, protocol::ResponseMessage& resp) {
-            resp.ok = true;
-            resp.code = protocol::ErrorCode::Ok;
-            resp.msg = "admin_pong";
-            resp.data.fields.clear();
-        });
+namespace {
+
+protocol::JsonValue PhaseJson(const LatencyHistogram::Snapshot& h) {
+    protocol::JsonValue v = protocol::MakeObject();
+    auto& f = v.o->fields;
+    f["p50"] = protocol::MakeNumber(static_cast<int64_t>(h.Percentile(0.50)));
+    f["p90"] = protocol::MakeNumber(static_cast<int64_t>(h.Percentile(0.90)));
+    f["p99"] = protocol::MakeNumber(static_cast<int64_t>(h.Percentile(0.99)));
+    f["p999"] = protocol::MakeNumber(static_cast<int64_t>(h.Percentile(0.999)));
+    f["max"] = protocol::MakeNumber(static_cast<int64_t>(h.max));
+    f["mean"] = protocol::MakeNumber(static_cast<int64_t>(h.Mean()));
+    return v;
+}
+
+protocol::JsonValue CommandJson(size_t slot, const CommandStats::Snapshot& s, int64_t windowMs) {
+    protocol::JsonValue v = protocol::MakeObject();
+    auto& f = v.o->fields;
+    f["cmd"] = protocol::MakeString(CommandStats::SlotName(slot));
+    f["count"] = protocol::MakeNumber(static_cast<int64_t>(s.count));
+    f["window_ms"] = protocol::MakeNumber(windowMs);
+    // In thousandths of a request per second, so low rates keep precision.
+    f["rate_milli_per_s"] = protocol::MakeNumber(
+        windowMs > 0 ? static_cast<int64_t>(s.count * 1000000 / static_cast<uint64_t>(windowMs)) : 0);
+    f["errors"] = protocol::MakeNumber(static_cast<int64_t>(s.errors));
+    f["bytes_in"] = protocol::MakeNumber(static_cast<int64_t>(s.bytesIn));
+    f["bytes_out"] = protocol::MakeNumber(static_cast<int64_t>(s.bytesOut));
+
+    protocol::JsonValue codes = protocol::MakeObject();
+    for (size_t i = 0; i < s.codes.size(); ++i) {
+        if (s.codes[i] != 0) {
+            codes.o->fields[protocol::ErrorCodeToString(CommandStats::kTrackedCodes[i])] =
+                protocol::MakeNumber(static_cast<int64_t>(s.codes[i]));
+        }
+    }
+    f["codes"] = std::move(codes);
+
+    // Microseconds.
+    protocol::JsonValue phases = protocol::MakeObject();
+    for (size_t i = 0; i < CommandStats::kPhaseCount; ++i) {
+        phases.o->fields[CommandStats::PhaseName(static_cast<CommandStats::Phase>(i))] =
+            PhaseJson(s.phases[i]);
+    }
+    f["latency_us"] = std::move(phases);
+    return v;
+}
+
+} // namespace
+
+void RegisterAdminHandlers(CommandRouter& router, ConfigStore& configs) {
+    router.RegisterStatic("ADMIN_PING", Session::Level::High, StaticReply::AdminPong);
      // ➕ 新增 RUN 命令（仅 High 权限可用）
     router.RegisterCommand("RUN", Session::Level::High,
         [](const protocol::RequestMessage& req, Session&, protocol::ResponseMessage& resp) {
             std::string cmd;
-            if (!protocol::GetString(req.args, "cmd", cmd) || cmd.empty()) {
+            if (!protocol::GetString(req.argsView, "cmd", cmd) || cmd.empty()) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "Missing or empty 'cmd' argument";
@@ -41,6 +88,119 @@ void RegisterAdminHandlers(CommandRouter& router) {
             }
             resp.data.fields.clear();
         });
+
+    router.RegisterCommand("RELOAD_CONFIG", Session::Level::High,
+        [&configs](const protocol::RequestMessage&, Session&, protocol::ResponseMessage& resp) {
+            std::string err;
+            const ConfigLoadResult result = configs.Reload(err);
+            resp.data.fields.clear();
+            if (result != ConfigLoadResult::Ok) {
+                resp.ok = false;
+                resp.code = protocol::ErrorCode::InternalError;
+                resp.msg = "reload failed: " + err;
+                return;
+            }
+            UTIL_LOG(Info) << "config reloaded from " << configs.source()
+                           << " generation=" << configs.generation();
+            resp.ok = true;
+            resp.code = protocol::ErrorCode::Ok;
+            resp.msg = "config_reloaded";
+            resp.data.fields["source"] = protocol::MakeString(configs.source());
+            resp.data.fields["generation"] = protocol::MakeNumber(static_cast<int64_t>(configs.generation()));
+        });
+
+    // args: cmd (optional, limits the output to one command), reset (bool,
+    // clears the counters after reading them). With cmd, reset clears only
+    // that command's counters; each command reports its own window_ms, and
+    // the top-level window_ms is the longest of them.
+    router.RegisterCommand("STATS", Session::Level::High,
+        [&router](const protocol::RequestMessage& req, Session&, protocol::ResponseMessage& resp) {
+            CommandStats& stats = router.stats();
+            size_t first = 0;
+            size_t last = CommandStats::kSlots;
+            std::string_view only;
+            if (protocol::GetString(req.argsView, "cmd", only)) {
+                CommandId id;
+                if (!LookupCommand(only, id)) {
+                    resp.ok = false;
+                    resp.code = protocol::ErrorCode::BadRequest;
+                    resp.msg = "args.cmd is not a built-in command";
+                    resp.data.fields.clear();
+                    return;
+                }
+                first = static_cast<size_t>(id);
+                last = first + 1;
+            }
+            bool reset = false;
+            protocol::GetBool(req.argsView, "reset", reset);
+
+            const auto now = std::chrono::steady_clock::now();
+            int64_t longestMs = 0;
+            protocol::JsonValue commands = protocol::MakeArray();
+            CommandStats::Snapshot snap;
+            for (size_t slot = first; slot < last; ++slot) {
+                const int64_t windowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - stats.since(slot)).count();
+                if (windowMs > longestMs) {
+                    longestMs = windowMs;
+                }
+                if (stats.count(slot) == 0) {
+                    continue;
+                }
+                stats.Load(slot, snap);
+                commands.a->items.push_back(CommandJson(slot, snap, windowMs));
+            }
+            if (reset) {
+                stats.Reset(first, last);
+            }
+
+            resp.ok = true;
+            resp.code = protocol::ErrorCode::Ok;
+            resp.msg = "OK";
+            resp.data.fields.clear();
+            resp.data.fields["window_ms"] = protocol::MakeNumber(longestMs);
+            resp.data.fields["reset"] = protocol::MakeBool(reset);
+            resp.data.fields["commands"] = std::move(commands);
+        });
+
+    // Writes the buffered trace spans to storage_dir as Chrome trace JSON,
+    // to be fetched with DOWNLOAD. args: clear (bool, default true), sample
+    // (sets the 1-in-N sampling rate after the dump; 0 turns tracing off).
+    router.RegisterCommand("TRACE_DUMP", Session::Level::High,
+        [&configs](const protocol::RequestMessage& req, Session&, protocol::ResponseMessage& resp) {
+            Tracer& tracer = Tracer::Instance();
+            int64_t sample = tracer.sampleEvery();
+            if (protocol::GetNumber(req.argsView, "sample", sample) && (sample < 0 || sample > 1000000)) {
+                resp.ok = false;
+                resp.code = protocol::ErrorCode::BadRequest;
+                resp.msg = "args.sample must be between 0 and 1000000";
+                resp.data.fields.clear();
+                return;
+            }
+            bool clear = true;
+            protocol::GetBool(req.argsView, "clear", clear);
+
+            std::string file;
+            std::string err;
+            size_t spans = 0;
+            if (!DumpTraceFile(configs.Get()->storageDir, clear, file, spans, err)) {
+                resp.ok = false;
+                resp.code = protocol::ErrorCode::InternalError;
+                resp.msg = "trace dump failed: " + err;
+                resp.data.fields.clear();
+                return;
+            }
+            BumpStorageGeneration();
+            tracer.setSampleEvery(static_cast<uint32_t>(sample));
+
+            resp.ok = true;
+            resp.code = protocol::ErrorCode::Ok;
+            resp.msg = "OK";
+            resp.data.fields.clear();
+            resp.data.fields["file"] = protocol::MakeString(file);
+            resp.data.fields["spans"] = protocol::MakeNumber(static_cast<int64_t>(spans));
+            resp.data.fields["sample"] = protocol::MakeNumber(sample);
+        });
 }
 
 } // namespace server
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "../core/CommandRouter.h"
+#include "../core/ServerConfig.h"
 
 namespace server {
 
-void RegisterAdminHandlers(CommandRouter& router);
+void RegisterAdminHandlers(CommandRouter& router, ConfigStore& configs);
 
 } // namespace server
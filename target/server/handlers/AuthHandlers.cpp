@@ -1,11 +1,11 @@
 #include "AuthHandlers.h"
 
-#include <iostream>
 #include<cstdio>
 #include <cstring>
 
 #include "../../common/protocol/JsonLite.h"
 #include "../../common/crypto/DesCipher.h"
+#include "../../common/utils/Logger.h"
 
 namespace server {
 
@@ -66,9 +66,10 @@ int AdminLogin(const std::string& cipherHex,
 
 } // namespace
 
-void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
+void RegisterAuthHandlers(CommandRouter& router, const ConfigStore& configs) {
     router.RegisterCommand("LOGIN_LOW", Session::Level::Guest,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [&configs](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+            const ConfigStore::Snapshot config = configs.Get();
             if (session.level() != Session::Level::Guest) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
@@ -77,10 +78,10 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
             std::string user;
-            protocol::GetString(req.args, "username", user);
+            protocol::GetString(req.argsView, "username", user);
 
             std::string pass;
-            if (!protocol::GetString(req.args, "password", pass)) {
+            if (!protocol::GetString(req.argsView, "password", pass)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "args.password required";
@@ -89,10 +90,10 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             bool matched = false;
-            if (!config.lowPassword.empty()) {
-                matched = (pass == config.lowPassword);
+            if (!config->lowPassword.empty()) {
+                matched = (pass == config->lowPassword);
             } else if (!user.empty()) {
-                for (const auto& u : config.lowUsers) {
+                for (const auto& u : config->lowUsers) {
                     if (u.username == user && u.password == pass) {
                         matched = true;
                         break;
@@ -100,7 +101,7 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
                 }
             }
             if (!matched) {
-                std::cout << "LOGIN_LOW failed for user: " << user << "\n";
+                UTIL_LOG(Info) << "LOGIN_LOW failed for user: " << user;
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "auth failed";
@@ -115,7 +116,7 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
             session.setUsername(user);
             session.setLowUsername(user);
 
-            std::cout << "LOGIN_LOW success for user: " << user << "\n";
+            UTIL_LOG(Info) << "LOGIN_LOW success for user: " << user;
             resp.ok = true;
             resp.code = protocol::ErrorCode::Ok;
             resp.msg = "login_low_ok";
@@ -125,7 +126,8 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
         });
 
     router.RegisterCommand("LOGIN_HIGH", Session::Level::Low,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [&configs](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+            const ConfigStore::Snapshot config = configs.Get();
             if (session.level() != Session::Level::Low) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
@@ -134,10 +136,10 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
             std::string user;
-            protocol::GetString(req.args, "username", user);
+            protocol::GetString(req.argsView, "username", user);
 
             std::string cipherHex;
-            if (!protocol::GetString(req.args, "password_cipher_hex", cipherHex)) {
+            if (!protocol::GetString(req.argsView, "password_cipher_hex", cipherHex)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "args.password_cipher_hex required";
@@ -147,8 +149,8 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
 
             std::string expectedHex;
             std::string encErr;
-            if (!crypto::DesEncryptEcbPkcs7Hex(config.adminPassPlain, config.desKeyBytes, expectedHex, encErr)) {
-                std::cout << "LOGIN_HIGH encrypt error: " << encErr << "\n";
+            if (!crypto::DesEncryptEcbPkcs7Hex(config->adminPassPlain, config->desKeyBytes, expectedHex, encErr)) {
+                UTIL_LOG(Error) << "LOGIN_HIGH encrypt error: " << encErr;
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::InternalError;
                 resp.msg = "internal error";
@@ -159,7 +161,7 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
             std::string err;
             const int admin = AdminLogin(cipherHex, expectedHex, err);
             if (admin == 0) {
-                std::cout << "LOGIN_HIGH auth failed for user: " << user << " (" << err << ")\n";
+                UTIL_LOG(Info) << "LOGIN_HIGH auth failed for user: " << user << " (" << err << ")";
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "auth failed";
@@ -168,10 +170,10 @@ void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             session.setLevel(Session::Level::High);
-            session.setUsername(config.adminUser);
+            session.setUsername(config->adminUser);
 
-            const std::string displayUser = user.empty() ? config.adminUser : user;
-            std::cout << "LOGIN_HIGH success for user: " << displayUser << "\n";
+            const std::string displayUser = user.empty() ? config->adminUser : user;
+            UTIL_LOG(Info) << "LOGIN_HIGH success for user: " << displayUser;
             resp.ok = true;
             resp.code = protocol::ErrorCode::Ok;
             resp.msg = "login_high_ok";
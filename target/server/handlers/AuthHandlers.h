@@ -5,6 +5,6 @@
 
 namespace server {
 
-void RegisterAuthHandlers(CommandRouter& router, const ServerConfig& config);
+void RegisterAuthHandlers(CommandRouter& router, const ConfigStore& configs);
 
 } // namespace server
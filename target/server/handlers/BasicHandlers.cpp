@@ -12,10 +12,6 @@ namespace server {
 
 namespace {
 
-bool GetStringArg(const protocol::JsonObject& args, const std::string& key, std::string& out) {
-    return protocol::GetString(args, key, out);
-}
-
 void SetString(protocol::JsonObject& obj, const std::string& key, const std::string& value) {
     obj.fields[key] = protocol::MakeString(value);
 }
@@ -35,13 +31,7 @@ std::string NowString() {
 } // namespace
 
 void RegisterBasicHandlers(CommandRouter& router) {
-    router.RegisterCommand("PING", Session::Level::Guest,
-        [](const protocol::RequestMessage&, Session&, protocol::ResponseMessage& resp) {
-            resp.ok = true;
-            resp.code = protocol::ErrorCode::Ok;
-            resp.msg = "pong";
-            resp.data.fields.clear();
-        });
+    router.RegisterStatic("PING", Session::Level::Guest, StaticReply::Pong);
 
     router.RegisterCommand("HELP", Session::Level::Guest,
         [](const protocol::RequestMessage&, Session& session, protocol::ResponseMessage& resp) {
@@ -65,6 +55,7 @@ void RegisterBasicHandlers(CommandRouter& router) {
             add("EXIT", "Exit the client");
             add("PING", "Ping server");
             add("ECHO", "Echo text back");
+            add("BATCH", "Run several commands in one request");
 
             if (session.level() == Session::Level::Guest) {
                 add("LOGIN_LOW", "Login as low user");
@@ -86,6 +77,9 @@ void RegisterBasicHandlers(CommandRouter& router) {
                 add("UPLOAD", "Upload file to server");
                 add("DOWNLOAD", "Download file from server");
                 add("RUN", "Run shell command on server");
+                add("RELOAD_CONFIG", "Reload server config");
+                add("STATS", "Show per-command latency statistics");
+                add("TRACE_DUMP", "Write sampled request traces to storage");
             }
 
             resp.data.fields["commands"] = arr;
@@ -104,7 +98,7 @@ void RegisterBasicHandlers(CommandRouter& router) {
     router.RegisterCommand("ECHO", Session::Level::Guest,
         [](const protocol::RequestMessage& req, Session&, protocol::ResponseMessage& resp) {
             std::string text;
-            if (!GetStringArg(req.args, "text", text)) {
+            if (!protocol::GetString(req.argsView, "text", text)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "args.text required";
@@ -0,0 +1,110 @@
+#include "BatchHandlers.h"
+
+#include "../../common/protocol/JsonLite.h"
+#include "../../common/protocol/JsonView.h"
+
+namespace server {
+
+namespace {
+
+// Keeps a batch well inside JsonLimits::maxArraySize and bounds the work one
+// frame can queue up.
+const size_t kMaxBatchItems = 32;
+
+// Commands that change the session's level or carry bulk payloads run on
+// their own, so every sub-request sees the level the batch started with and
+// the combined response stays small.
+bool AllowedInBatch(CommandId id) {
+    switch (id) {
+    case CommandId::Batch:
+    case CommandId::LoginLow:
+    case CommandId::LoginHigh:
+    case CommandId::Logout:
+    case CommandId::UploadChunk:
+    case CommandId::DownloadChunk:
+        return false;
+    default:
+        return true;
+    }
+}
+
+protocol::JsonValue MakeResult(std::string_view cmd, protocol::ResponseMessage&& sub) {
+    protocol::JsonValue item = protocol::MakeObject();
+    auto& fields = item.o->fields;
+    fields.reserve(5);
+    fields["cmd"] = protocol::MakeString(std::string(cmd));
+    fields["ok"] = protocol::MakeBool(sub.ok);
+    fields["code"] = protocol::MakeNumber(protocol::ErrorCodeToInt(sub.code));
+    fields["msg"] = protocol::MakeString(std::move(sub.msg));
+    protocol::JsonValue data = protocol::MakeObject();
+    *data.o = std::move(sub.data);
+    fields["data"] = std::move(data);
+    return item;
+}
+
+protocol::ResponseMessage MakeSubError(protocol::ErrorCode code, const std::string& msg) {
+    protocol::ResponseMessage resp;
+    resp.ok = false;
+    resp.code = code;
+    resp.msg = msg;
+    return resp;
+}
+
+} // namespace
+
+void RegisterBatchHandlers(CommandRouter& router) {
+    router.RegisterCommand("BATCH", Session::Level::Guest,
+        [&router](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+            protocol::JsonView requests;
+            if (!protocol::GetArray(req.argsView, "requests", requests) || requests.size() == 0 ||
+                requests.size() > kMaxBatchItems) {
+                resp.ok = false;
+                resp.code = protocol::ErrorCode::BadRequest;
+                resp.msg = "requests must be an array of 1-" + std::to_string(kMaxBatchItems) + " items";
+                resp.data.fields.clear();
+                return;
+            }
+            bool stopOnError = false;
+            protocol::GetBool(req.argsView, "stop_on_error", stopOnError);
+
+            protocol::JsonValue results = protocol::MakeArray();
+            results.a->items.reserve(requests.size());
+            bool stopped = false;
+
+            // Sub-requests read their args straight out of the batch frame's
+            // document, which outlives the loop.
+            for (size_t i = 0; i < requests.size(); ++i) {
+                const protocol::JsonView item = requests.at(i);
+                protocol::RequestMessage sub;
+                protocol::ResponseMessage subResp;
+                std::string_view cmd;
+                CommandId id = CommandId::Count;
+                if (!protocol::GetString(item, "cmd", cmd)) {
+                    subResp = MakeSubError(protocol::ErrorCode::BadRequest, "bad sub-request");
+                } else if (LookupCommand(cmd, id) && !AllowedInBatch(id)) {
+                    subResp = MakeSubError(protocol::ErrorCode::BadRequest, "not allowed in batch");
+                } else {
+                    sub.cmd.assign(cmd.data(), cmd.size());
+                    protocol::GetObject(item, "args", sub.argsView);
+                    router.Execute(session, sub, subResp);
+                }
+
+                const bool failed = !subResp.ok;
+                results.a->items.push_back(MakeResult(cmd, std::move(subResp)));
+                if (failed && stopOnError) {
+                    stopped = true;
+                    break;
+                }
+            }
+
+            resp.ok = true;
+            resp.code = protocol::ErrorCode::Ok;
+            resp.msg = "batch_ok";
+            resp.data.fields.clear();
+            resp.data.fields["completed"] = protocol::MakeNumber(static_cast<int64_t>(results.a->items.size()));
+            resp.data.fields["stopped"] = protocol::MakeBool(stopped);
+            resp.data.fields["results"] = std::move(results);
+        });
+}
+
+} // namespace server
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "../core/CommandRouter.h"
+
+namespace server {
+
+void RegisterBatchHandlers(CommandRouter& router);
+
+} // namespace server
@@ -8,6 +8,8 @@
 #include <sstream>
 
 #include "../../common/utils/Base64.h"
+#include "../core/ResponseCache.h"
+#include "../core/Trace.h"
 
 namespace server {
 
@@ -114,13 +116,14 @@ std::mutex& FileMutex() {
 
 } // namespace
 
-void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
+void RegisterFileHandlers(CommandRouter& router, const ConfigStore& configs) {
     router.RegisterCommand("LIST_FILES", Session::Level::High,
-        [config](const protocol::RequestMessage&, Session&, protocol::ResponseMessage& resp) {
+        [&configs](const protocol::RequestMessage&, Session&, protocol::ResponseMessage& resp) {
+            const ConfigStore::Snapshot config = configs.Get();
             protocol::JsonValue arr = protocol::MakeArray();
             std::error_code ec;
             size_t count = 0;
-            for (const auto& entry : std::filesystem::directory_iterator(config.storageDir, ec)) {
+            for (const auto& entry : std::filesystem::directory_iterator(config->storageDir, ec)) {
                 if (ec) {
                     break;
                 }
@@ -155,7 +158,8 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
         });
 
     router.RegisterCommand("UPLOAD_INIT", Session::Level::High,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [&configs](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+            const ConfigStore::Snapshot config = configs.Get();
             auto& st = session.upload();
             if (st.inProgress) {
                 resp.ok = false;
@@ -166,7 +170,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             std::string filename;
-            if (!protocol::GetString(req.args, "filename", filename) || !IsSafeFilename(filename)) {
+            if (!protocol::GetString(req.argsView, "filename", filename) || !IsSafeFilename(filename)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "invalid filename";
@@ -175,7 +179,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             int64_t fileSize = 0;
-            if (!protocol::GetNumber(req.args, "file_size", fileSize) || fileSize <= 0) {
+            if (!protocol::GetNumber(req.argsView, "file_size", fileSize) || fileSize <= 0) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "invalid file_size";
@@ -183,7 +187,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            if (static_cast<uint64_t>(fileSize) > config.maxFileSize) {
+            if (static_cast<uint64_t>(fileSize) > config->maxFileSize) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "file too large";
@@ -192,18 +196,18 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             int64_t chunkSize = 0;
-            if (protocol::GetNumber(req.args, "chunk_size", chunkSize) && chunkSize > 0) {
-                if (chunkSize > config.maxChunkBytes) {
-                    chunkSize = config.maxChunkBytes;
+            if (protocol::GetNumber(req.argsView, "chunk_size", chunkSize) && chunkSize > 0) {
+                if (chunkSize > config->maxChunkBytes) {
+                    chunkSize = config->maxChunkBytes;
                 }
             } else {
-                chunkSize = config.maxChunkBytes;
+                chunkSize = config->maxChunkBytes;
             }
 
             const std::string uploadId = NewUploadId();
             std::string finalName = filename;
-            const std::string finalPath = JoinPath(config.storageDir, finalName);
-            if (config.overwrite == "reject" && FileExists(finalPath)) {
+            const std::string finalPath = JoinPath(config->storageDir, finalName);
+            if (config->overwrite == "reject" && FileExists(finalPath)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::FileExists;
                 resp.msg = "file exists";
@@ -211,7 +215,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            const std::string tempPath = JoinPath(config.storageDir, finalName + "." + uploadId + ".part");
+            const std::string tempPath = JoinPath(config->storageDir, finalName + "." + uploadId + ".part");
             std::remove(tempPath.c_str());
 
             auto stream = std::make_unique<std::ofstream>(tempPath, std::ios::binary | std::ios::out | std::ios::trunc);
@@ -223,8 +227,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            st.reset();
-            st.inProgress = true;
+            st.begin();
             st.uploadId = uploadId;
             st.finalName = finalName;
             st.tempPath = tempPath;
@@ -233,6 +236,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             st.nextIndex = 0;
             st.chunkSize = static_cast<uint32_t>(chunkSize);
             st.stream = std::move(stream);
+            st.config = config;
 
             resp.ok = true;
             resp.code = protocol::ErrorCode::Ok;
@@ -244,7 +248,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
         });
 
     router.RegisterCommand("UPLOAD_CHUNK", Session::Level::High,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
             auto& st = session.upload();
             if (!st.inProgress) {
                 resp.ok = false;
@@ -255,7 +259,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             std::string uploadId;
-            if (!protocol::GetString(req.args, "upload_id", uploadId) || uploadId != st.uploadId) {
+            if (!protocol::GetString(req.argsView, "upload_id", uploadId) || uploadId != st.uploadId) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::TransferStateError;
                 resp.msg = "upload_id mismatch";
@@ -264,7 +268,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             int64_t index = -1;
-            if (!protocol::GetNumber(req.args, "chunk_index", index) || index < 0) {
+            if (!protocol::GetNumber(req.argsView, "chunk_index", index) || index < 0) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "invalid chunk_index";
@@ -281,8 +285,10 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            std::string dataB64;
-            if (!protocol::GetString(req.args, "data_b64", dataB64)) {
+            // Views the frame directly; only an escaped payload (e.g. "\/")
+            // is unescaped, into the request's document arena.
+            std::string_view dataB64;
+            if (!protocol::GetString(req.argsView, "data_b64", dataB64)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "data_b64 required";
@@ -290,8 +296,16 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            std::vector<uint8_t> bytes;
-            if (!util::Base64Decode(dataB64, bytes)) {
+            const size_t maxDecoded = util::Base64DecodedMaxSize(dataB64.size());
+            if (st.writeBuffer.size() < maxDecoded) {
+                st.writeBuffer.resize(maxDecoded);
+            }
+            size_t decoded = 0;
+            TraceSpan decodeSpan("base64_decode");
+            const bool decodedOk = util::Base64Decode(dataB64.data(), dataB64.size(),
+                                                      st.writeBuffer.data(), st.writeBuffer.size(), decoded);
+            decodeSpan.end(decoded);
+            if (!decodedOk) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "invalid base64";
@@ -299,7 +313,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            if (bytes.size() > config.maxChunkBytes) {
+            if (decoded > st.config->maxChunkBytes) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "chunk too large";
@@ -307,7 +321,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            if (st.receivedSize + bytes.size() > st.declaredSize) {
+            if (st.receivedSize + decoded > st.declaredSize) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::SizeMismatch;
                 resp.msg = "size overflow";
@@ -316,8 +330,10 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            st.stream->write(reinterpret_cast<const char*>(bytes.data()),
-                             static_cast<std::streamsize>(bytes.size()));
+            TraceSpan writeSpan("disk_write");
+            st.stream->write(reinterpret_cast<const char*>(st.writeBuffer.data()),
+                             static_cast<std::streamsize>(decoded));
+            writeSpan.end(decoded);
             if (!(*st.stream)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::InternalError;
@@ -327,7 +343,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            st.receivedSize += bytes.size();
+            st.receivedSize += decoded;
             st.nextIndex += 1;
 
             resp.ok = true;
@@ -339,7 +355,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
         });
 
     router.RegisterCommand("UPLOAD_FINISH", Session::Level::High,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
             auto& st = session.upload();
             if (!st.inProgress) {
                 resp.ok = false;
@@ -348,9 +364,11 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 resp.data.fields.clear();
                 return;
             }
+            // Finish with the config the upload started under.
+            const ConfigStore::Snapshot config = st.config;
 
             std::string uploadId;
-            if (!protocol::GetString(req.args, "upload_id", uploadId) || uploadId != st.uploadId) {
+            if (!protocol::GetString(req.argsView, "upload_id", uploadId) || uploadId != st.uploadId) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::TransferStateError;
                 resp.msg = "upload_id mismatch";
@@ -359,6 +377,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             if (st.stream) {
+                TraceSpan flushSpan("disk_flush");
                 st.stream->flush();
                 st.stream->close();
             }
@@ -373,11 +392,11 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             std::string finalName = st.finalName;
-            std::string finalPath = JoinPath(config.storageDir, finalName);
+            std::string finalPath = JoinPath(config->storageDir, finalName);
             {
                 std::lock_guard<std::mutex> lock(FileMutex());
                 if (FileExists(finalPath)) {
-                    if (config.overwrite == "reject") {
+                    if (config->overwrite == "reject") {
                         resp.ok = false;
                         resp.code = protocol::ErrorCode::FileExists;
                         resp.msg = "file exists";
@@ -385,15 +404,20 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                         ResetUpload(session, true);
                         return;
                     }
-                    if (config.overwrite == "rename") {
-                        finalName = MakeUniqueName(config.storageDir, finalName);
-                        finalPath = JoinPath(config.storageDir, finalName);
-                    } else if (config.overwrite == "overwrite") {
+                    if (config->overwrite == "rename") {
+                        finalName = MakeUniqueName(config->storageDir, finalName);
+                        finalPath = JoinPath(config->storageDir, finalName);
+                    } else if (config->overwrite == "overwrite") {
                         std::remove(finalPath.c_str());
                     }
                 }
 
-                if (std::rename(st.tempPath.c_str(), finalPath.c_str()) != 0) {
+                // Bump after the directory changed (an "overwrite" removal
+                // counts even if the rename fails), so a LIST_FILES that
+                // scanned before the change is never cached as current.
+                const bool renamed = std::rename(st.tempPath.c_str(), finalPath.c_str()) == 0;
+                BumpStorageGeneration();
+                if (!renamed) {
                     resp.ok = false;
                     resp.code = protocol::ErrorCode::InternalError;
                     resp.msg = "rename failed";
@@ -415,7 +439,8 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
         });
 
     router.RegisterCommand("DOWNLOAD_INIT", Session::Level::High,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [&configs](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+            const ConfigStore::Snapshot config = configs.Get();
             auto& st = session.download();
             if (st.inProgress) {
                 resp.ok = false;
@@ -426,7 +451,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             std::string filename;
-            if (!protocol::GetString(req.args, "filename", filename) || !IsSafeFilename(filename)) {
+            if (!protocol::GetString(req.argsView, "filename", filename) || !IsSafeFilename(filename)) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "invalid filename";
@@ -434,7 +459,7 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            const std::string path = JoinPath(config.storageDir, filename);
+            const std::string path = JoinPath(config->storageDir, filename);
             std::error_code ec;
             const uint64_t fileSize = std::filesystem::file_size(path, ec);
             if (ec) {
@@ -446,16 +471,16 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
             }
 
             int64_t chunkSize = 0;
-            if (protocol::GetNumber(req.args, "chunk_size", chunkSize) && chunkSize > 0) {
-                if (chunkSize > config.maxChunkBytes) {
-                    chunkSize = config.maxChunkBytes;
+            if (protocol::GetNumber(req.argsView, "chunk_size", chunkSize) && chunkSize > 0) {
+                if (chunkSize > config->maxChunkBytes) {
+                    chunkSize = config->maxChunkBytes;
                 }
             } else {
-                chunkSize = config.maxChunkBytes;
+                chunkSize = config->maxChunkBytes;
             }
 
-            auto stream = std::make_unique<std::ifstream>(path, std::ios::binary);
-            if (!stream->is_open()) {
+            auto reader = std::make_unique<ReadAhead>(path, fileSize, static_cast<uint32_t>(chunkSize));
+            if (!reader->is_open()) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::InternalError;
                 resp.msg = "open file failed";
@@ -463,15 +488,14 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 return;
             }
 
-            st.reset();
-            st.inProgress = true;
+            st.begin();
             st.downloadId = NewDownloadId();
             st.filename = filename;
             st.path = path;
             st.fileSize = fileSize;
             st.nextIndex = 0;
             st.chunkSize = static_cast<uint32_t>(chunkSize);
-            st.stream = std::move(stream);
+            st.reader = std::move(reader);
 
             resp.ok = true;
             resp.code = protocol::ErrorCode::Ok;
@@ -484,32 +508,32 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
         });
 
     router.RegisterCommand("DOWNLOAD_CHUNK", Session::Level::High,
-        [config](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) {
+        [](const protocol::RequestMessage& req, Session& session, protocol::ResponseMessage& resp) -> Task<> {
             auto& st = session.download();
             if (!st.inProgress) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::TransferStateError;
                 resp.msg = "no download in progress";
                 resp.data.fields.clear();
-                return;
+                co_return;
             }
 
             std::string downloadId;
-            if (!protocol::GetString(req.args, "download_id", downloadId) || downloadId != st.downloadId) {
+            if (!protocol::GetString(req.argsView, "download_id", downloadId) || downloadId != st.downloadId) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::TransferStateError;
                 resp.msg = "download_id mismatch";
                 resp.data.fields.clear();
-                return;
+                co_return;
             }
 
             int64_t index = -1;
-            if (!protocol::GetNumber(req.args, "chunk_index", index) || index < 0) {
+            if (!protocol::GetNumber(req.argsView, "chunk_index", index) || index < 0) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::BadRequest;
                 resp.msg = "invalid chunk_index";
                 resp.data.fields.clear();
-                return;
+                co_return;
             }
 
             if (static_cast<uint32_t>(index) != st.nextIndex) {
@@ -518,32 +542,33 @@ void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config) {
                 resp.msg = "chunk_index mismatch";
                 resp.data.fields.clear();
                 SetNumber(resp.data, "expected_index", st.nextIndex);
-                return;
+                co_return;
             }
 
-            std::vector<uint8_t> buffer(static_cast<size_t>(st.chunkSize));
-            st.stream->read(reinterpret_cast<char*>(buffer.data()),
-                            static_cast<std::streamsize>(buffer.size()));
-            const std::streamsize got = st.stream->gcount();
-            if (got < 0) {
+            const uint64_t offset = static_cast<uint64_t>(st.nextIndex) * st.chunkSize;
+            TraceSpan readSpan("disk_read_wait");
+            const ReadAhead::Buffer buffer = co_await st.reader->Take(st.nextIndex);
+            readSpan.end(buffer ? buffer->size() : 0);
+            if (!buffer) {
                 resp.ok = false;
                 resp.code = protocol::ErrorCode::InternalError;
                 resp.msg = "read failed";
                 resp.data.fields.clear();
                 ResetDownload(session);
-                return;
+                co_return;
             }
-            buffer.resize(static_cast<size_t>(got));
 
-            const bool isLast = (st.stream->eof() || st.stream->peek() == std::ifstream::traits_type::eof());
-            const std::string b64 = util::Base64Encode(buffer);
+            const bool isLast = buffer->size() < st.chunkSize || offset + buffer->size() >= st.fileSize;
+            TraceSpan encodeSpan("base64_encode");
+            std::string b64 = util::Base64Encode(*buffer);
+            encodeSpan.end(buffer->size());
 
             resp.ok = true;
             resp.code = protocol::ErrorCode::Ok;
             resp.msg = "chunk_ok";
             resp.data.fields.clear();
             SetNumber(resp.data, "chunk_index", static_cast<int64_t>(st.nextIndex));
-            SetString(resp.data, "data_b64", b64);
+            resp.data.fields["data_b64"] = protocol::MakeString(std::move(b64));
             SetBool(resp.data, "is_last", isLast);
 
             st.nextIndex += 1;
@@ -5,6 +5,6 @@
 
 namespace server {
 
-void RegisterFileHandlers(CommandRouter& router, const ServerConfig& config);
+void RegisterFileHandlers(CommandRouter& router, const ConfigStore& configs);
 
 } // namespace server
@@ -1,4 +1,6 @@
 #include <atomic>
+#include <chrono>
+#include <csignal>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -11,11 +13,18 @@
 #include "../common/net/FramedIO.h"
 #include "../common/net/SocketInit.h"
 #include "../common/protocol/Message.h"
+#include "../common/utils/Logger.h"
 #include "core/CommandRouter.h"
+#include "core/Metrics.h"
+#include "core/MetricsEndpoint.h"
+#include "core/RequestContext.h"
 #include "core/ServerConfig.h"
+#include "core/StaticReplies.h"
+#include "core/Trace.h"
 #include "handlers/AuthHandlers.h"
 #include "handlers/AdminHandlers.h"
 #include "handlers/BasicHandlers.h"
+#include "handlers/BatchHandlers.h"
 #include "handlers/FileHandlers.h"
 
 #include <cstdio>
@@ -24,6 +33,21 @@ namespace {
 
 constexpr char kBanner[] = "PWNREMOTE/1.0 READY";
 
+#ifdef SIGHUP
+// Set from the signal handlers; the reload and the trace dump themselves run
+// on a normal thread.
+volatile std::sig_atomic_t g_reloadRequested = 0;
+volatile std::sig_atomic_t g_traceDumpRequested = 0;
+
+void OnReloadSignal(int) {
+    g_reloadRequested = 1;
+}
+
+void OnTraceDumpSignal(int) {
+    g_traceDumpRequested = 1;
+}
+#endif
+
 std::string AddrToString(const sockaddr_in& addr) {
     char ipBuf[INET_ADDRSTRLEN]{};
     InetNtopA(AF_INET, const_cast<in_addr*>(&addr.sin_addr), ipBuf, sizeof(ipBuf));
@@ -42,6 +66,22 @@ void CleanupSession(server::Session& session) {
     session.download().reset();
 }
 
+void LogRequestEvent(uint64_t connId, const server::RequestContext& ctx) {
+    using namespace std::chrono;
+    util::EventRecord ev;
+    ev.timeUs = static_cast<uint64_t>(
+        duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+    ev.connId = connId;
+    ev.latencyUs = static_cast<uint32_t>(
+        ctx.elapsedUs(server::RequestContext::Mark::Received, server::RequestContext::Mark::Sent));
+    ev.bytesIn = static_cast<uint32_t>(ctx.frame.size());
+    ev.bytesOut = static_cast<uint32_t>(ctx.responseBytes());
+    ev.code = protocol::ErrorCodeToInt(ctx.code);
+    ev.cmd = (ctx.cmd == server::CommandId::Count) ? util::EventRecord::kUnknownCmd
+                                                    : static_cast<uint16_t>(ctx.cmd);
+    util::Logger::event(ev);
+}
+
 } // namespace
 
 int main() {
@@ -54,34 +94,23 @@ int main() {
         return 1;
     }
 
-    server::ServerConfig config;
-    std::string configErr;
-    const std::string configPaths[] = {
+    server::ConfigStore configStore({
         "server/server_config.json",
         "../server/server_config.json",
         "server_config.json"
-    };
-    bool loaded = false;
-    bool invalid = false;
-    for (const auto& path : configPaths) {
-        const server::ConfigLoadResult result = server::LoadServerConfig(path, config, configErr);
-        if (result == server::ConfigLoadResult::Ok) {
-            std::cout << "Config loaded from " << path << "\n";
-            loaded = true;
-            break;
-        }
-        if (result == server::ConfigLoadResult::Invalid) {
-            std::cerr << "Config invalid: " << configErr << "\n";
-            invalid = true;
-            break;
-        }
-    }
-    if (invalid) {
+    });
+    std::string configErr;
+    const server::ConfigLoadResult loadResult = configStore.Reload(configErr);
+    if (loadResult == server::ConfigLoadResult::Invalid) {
+        std::cerr << "Config invalid: " << configErr << "\n";
         return 1;
     }
-    if (!loaded) {
+    if (loadResult == server::ConfigLoadResult::Ok) {
+        std::cout << "Config loaded from " << configStore.source() << "\n";
+    } else {
         std::cerr << "Config not found, using defaults\n";
     }
+    const server::ConfigStore::Snapshot config = configStore.Get();
 
     SOCKET listenSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (listenSock == INVALID_SOCKET) {
@@ -93,15 +122,15 @@ int main() {
     addr.sin_family = AF_INET;
     const unsigned short kServerPort = 9000;
     addr.sin_port = htons(kServerPort);
-    if (InetPtonA(AF_INET, config.bindIp.c_str(), &addr.sin_addr) != 1) {
-        std::cerr << "Invalid bind_ip: " << config.bindIp << "\n";
+    if (InetPtonA(AF_INET, config->bindIp.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Invalid bind_ip: " << config->bindIp << "\n";
         closesocket(listenSock);
         return 1;
     }
 
     if (bind(listenSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
         const int err = WSAGetLastError();
-        std::cerr << "bind() failed for " << config.bindIp;
+        std::cerr << "bind() failed for " << config->bindIp;
         if (err == WSAEADDRINUSE) {
             std::cerr << " (port is unavailable)";
         }
@@ -116,19 +145,90 @@ int main() {
         return 1;
     }
 
-    std::cout << "listening on " << config.bindIp << "\n";
+    std::cout << "listening on " << config->bindIp << "\n";
 
     std::string storageErr;
-    if (!server::EnsureStorageDir(config.storageDir, storageErr)) {
+    if (!server::EnsureStorageDir(config->storageDir, storageErr)) {
         std::cerr << "Storage dir error: " << storageErr << "\n";
         return 1;
     }
 
+    if (!config->eventLogPath.empty()) {
+        std::string eventErr;
+        if (!util::Logger::openEventLog(config->eventLogPath, config->eventLogFileBytes,
+                                        config->eventLogFiles, eventErr)) {
+            std::cerr << "Event log error: " << eventErr << "\n";
+            return 1;
+        }
+        std::cout << "event log: " << config->eventLogPath << "\n";
+    }
+
+    server::BuildStaticReplies();
+
     server::CommandRouter router;
-    server::RegisterAuthHandlers(router, config);
+    server::RegisterAuthHandlers(router, configStore);
     server::RegisterBasicHandlers(router);
-    server::RegisterAdminHandlers(router);
-    server::RegisterFileHandlers(router, config);
+    server::RegisterAdminHandlers(router, configStore);
+    server::RegisterFileHandlers(router, configStore);
+    server::RegisterBatchHandlers(router);
+
+    // HELP depends only on the session level. LIST_FILES changes with upload
+    // commits and with reloads that may move storage_dir; the age bound covers
+    // files changed behind the server's back (e.g. via RUN).
+    router.cache().Enable(server::CommandId::Help, {});
+    router.cache().Enable(server::CommandId::ListFiles,
+        {[&configStore]() { return server::StorageGeneration() + configStore.generation(); },
+         {},
+         std::chrono::seconds(2)});
+
+    server::MetricsEndpoint metrics(router);
+    if (config->metricsPort != 0) {
+        std::string metricsErr;
+        if (!metrics.Start(config->metricsPort, metricsErr)) {
+            std::cerr << "Metrics endpoint error: " << metricsErr << "\n";
+            closesocket(listenSock);
+            return 1;
+        }
+        std::cout << "metrics on http://127.0.0.1:" << config->metricsPort << "/metrics\n";
+    }
+
+    server::Tracer::Instance().setSampleEvery(config->traceSample);
+    if (config->traceSample != 0) {
+        std::cout << "tracing 1 in " << config->traceSample << " requests\n";
+    }
+
+#ifdef SIGHUP
+    std::signal(SIGHUP, OnReloadSignal);
+    std::signal(SIGUSR1, OnTraceDumpSignal);
+    std::thread([&configStore]() {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            if (g_traceDumpRequested) {
+                g_traceDumpRequested = 0;
+                std::string file;
+                std::string err;
+                size_t spans = 0;
+                if (server::DumpTraceFile(configStore.Get()->storageDir, true, file, spans, err)) {
+                    server::BumpStorageGeneration();
+                    UTIL_LOG(Info) << "trace dumped to " << file << " spans=" << spans;
+                } else {
+                    UTIL_LOG(Error) << "trace dump failed: " << err;
+                }
+            }
+            if (!g_reloadRequested) {
+                continue;
+            }
+            g_reloadRequested = 0;
+            std::string err;
+            if (configStore.Reload(err) == server::ConfigLoadResult::Ok) {
+                UTIL_LOG(Info) << "config reloaded from " << configStore.source()
+                               << " generation=" << configStore.generation();
+            } else {
+                UTIL_LOG(Error) << "config reload failed: " << err;
+            }
+        }
+    }).detach();
+#endif
 
     std::atomic<uint64_t> nextConnId{1};
 
@@ -137,7 +237,7 @@ int main() {
         int clientLen = sizeof(clientAddr);
         SOCKET clientSock = accept(listenSock, reinterpret_cast<sockaddr*>(&clientAddr), &clientLen);
         if (clientSock == INVALID_SOCKET) {
-            std::cerr << "accept() failed\n";
+            UTIL_LOG(Error) << "accept() failed";
             continue;
         }
 
@@ -145,47 +245,55 @@ int main() {
         send(clientSock, kBanner, bannerLen, 0);
 
         const uint64_t connId = nextConnId.fetch_add(1);
+        server::ServerMetrics::Instance().connectionsTotal.fetch_add(1, std::memory_order_relaxed);
         const std::string peer = AddrToString(clientAddr);
-        std::cout << "client connected id=" << connId << " from " << peer << "\n";
+        UTIL_LOG(Info) << "client connected id=" << connId << " from " << peer;
 
         std::thread([clientSock, clientAddr, connId, peer, &router]() {
+            server::ServerMetrics& metrics = server::ServerMetrics::Instance();
+            metrics.sessionsActive.fetch_add(1, std::memory_order_relaxed);
             server::Session session;
             std::string reason = "closed";
+            server::RequestContext ctx;
+            ctx.connId = connId;
 
             while (true) {
-                std::string reqJson;
-                if (!net::recvFrame(clientSock, reqJson)) {
+                if (!net::recvFrame(clientSock, ctx.frame, &ctx.arrived)) {
                     reason = "closed";
                     break;
                 }
 
-                protocol::RequestMessage req;
-                protocol::ErrorCode parseErr = protocol::ErrorCode::Ok;
-                if (protocol::DecodeRequest(reqJson, req, parseErr)) {
-                    std::cout << "recv request id=" << connId
-                              << " cmd=" << req.cmd
-                              << " level=" << session.levelString()
-                              << "\n";
+                if (ctx.Decode()) {
+                    UTIL_LOG(Info) << "recv request id=" << connId
+                                   << " cmd=" << ctx.req.cmd
+                                   << " level=" << session.levelString();
                 } else {
-                    std::cout << "recv request id=" << connId << " cmd=INVALID\n";
+                    UTIL_LOG(Info) << "recv request id=" << connId << " cmd=INVALID";
                 }
 
-                std::string respJson;
-                if (!router.Handle(session, reqJson, respJson)) {
+                if (!router.Handle(session, ctx)) {
                     reason = "error";
                     break;
                 }
 
-                if (!net::sendFrame(clientSock, respJson)) {
+                const bool sent = ctx.staticFrame.empty()
+                    ? net::sendFrameBuffer(clientSock, ctx.out)
+                    : net::sendAll(clientSock, ctx.staticFrame.data(), ctx.staticFrame.size());
+                if (!sent) {
                     reason = "error";
                     break;
                 }
+                router.Complete(ctx);
+                if (util::Logger::eventsEnabled()) {
+                    LogRequestEvent(connId, ctx);
+                }
             }
 
             CleanupSession(session);
             closesocket(clientSock);
-            std::cout << "client disconnected id=" << connId
-                      << " reason=" << reason << "\n";
+            metrics.sessionsActive.fetch_sub(1, std::memory_order_relaxed);
+            UTIL_LOG(Info) << "client disconnected id=" << connId
+                           << " reason=" << reason;
         }).detach();
     }
 
@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../common/crypto/DesCipher.h"
+#include "../../common/net/FramedIO.h"
+#include "../../common/protocol/JsonLite.h"
+#include "../../common/protocol/Message.h"
+#include "../../common/utils/Base64.h"
+#include "../../common/utils/Logger.h"
+#include "../../server/core/CommandRouter.h"
+#include "../../server/core/RequestContext.h"
+#include "../../server/core/StaticReplies.h"
+#include "../../server/handlers/BasicHandlers.h"
+
+// Microbenchmarks for the hot paths of the protocol stack. Inputs are built
+// from fixed seeds so runs are comparable; each benchmark is timed over
+// several repetitions and the median is reported. --save writes the results
+// as a baseline and --compare flags benchmarks that got slower than one.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef NDEBUG
+constexpr char kBuildFlavor[] = "release";
+#else
+constexpr char kBuildFlavor[] = "debug";
+#endif
+
+// Keeps the compiler from discarding a result the benchmark never reads.
+template <typename T>
+void KeepAlive(const T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    static const void* volatile sink;
+    sink = &value;
+#else
+    __asm__ __volatile__("" : : "r"(&value) : "memory");
+#endif
+}
+
+struct Benchmark {
+    std::string name;
+    // Payload bytes processed per iteration, for MB/s; 0 if not meaningful.
+    size_t bytes = 0;
+    std::function<void(size_t iterations)> run;
+};
+
+struct Result {
+    std::string name;
+    size_t bytes = 0;
+    double nsPerOp = 0;
+    double spreadPct = 0;   // (max - min) / median over the repetitions
+};
+
+struct BenchArgs {
+    bool showHelp = false;
+    bool list = false;
+    std::string filter;
+    uint32_t minTimeMs = 100;
+    uint32_t repetitions = 5;
+    std::string savePath;
+    std::string comparePath;
+    double thresholdPct = 10;
+};
+
+void PrintUsage() {
+    std::cout << "Usage: bench_core [--filter <substr>] [--min-time-ms <n>] [--repetitions <n>]\n"
+              << "                  [--save <baseline.json>] [--compare <baseline.json>] [--threshold <pct>]\n"
+              << "                  [--list]\n";
+}
+
+bool ParseArgs(int argc, char** argv, BenchArgs& out) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            out.showHelp = true;
+            return true;
+        }
+        if (arg == "--list") {
+            out.list = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value after " << arg << "\n";
+            return false;
+        }
+        const std::string value = argv[++i];
+        try {
+            if (arg == "--filter") {
+                out.filter = value;
+            } else if (arg == "--min-time-ms") {
+                out.minTimeMs = static_cast<uint32_t>(std::max(1ul, std::stoul(value)));
+            } else if (arg == "--repetitions") {
+                out.repetitions = static_cast<uint32_t>(std::max(1ul, std::stoul(value)));
+            } else if (arg == "--save") {
+                out.savePath = value;
+            } else if (arg == "--compare") {
+                out.comparePath = value;
+            } else if (arg == "--threshold") {
+                out.thresholdPct = std::stod(value);
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << ": " << value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Deterministic filler so every run sees the same bytes.
+std::vector<uint8_t> MakeBytes(size_t n, uint32_t seed) {
+    std::vector<uint8_t> out(n);
+    uint32_t x = seed ? seed : 1;
+    for (auto& b : out) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        b = static_cast<uint8_t>(x);
+    }
+    return out;
+}
+
+// Printable text with a few characters that need JSON escaping.
+std::string MakeText(size_t n, uint32_t seed) {
+    static constexpr char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 ,.-_\"\\/";
+    const std::vector<uint8_t> bytes = MakeBytes(n, seed);
+    std::string out(n, ' ');
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = kAlphabet[bytes[i] % (sizeof(kAlphabet) - 1)];
+    }
+    return out;
+}
+
+std::string SizeLabel(size_t n) {
+    if (n >= 1024 && n % 1024 == 0) {
+        return std::to_string(n / 1024) + "k";
+    }
+    return std::to_string(n);
+}
+
+protocol::RequestMessage MakeEchoRequest(size_t textBytes) {
+    protocol::RequestMessage req;
+    req.cmd = "ECHO";
+    req.args.fields["text"] = protocol::MakeString(MakeText(textBytes, 7));
+    return req;
+}
+
+const protocol::JsonLimits kBenchLimits{1024 * 1024, 1024 * 1024, 64, 64, 4};
+
+void AddJsonBenchmarks(std::vector<Benchmark>& out) {
+    for (size_t n : {64, 1024, 16384, 65536}) {
+        protocol::JsonValue doc = protocol::MakeObject();
+        doc.o->fields["type"] = protocol::MakeString("CMD");
+        doc.o->fields["cmd"] = protocol::MakeString("ECHO");
+        protocol::JsonValue args = protocol::MakeObject();
+        args.o->fields["text"] = protocol::MakeString(MakeText(n, 11));
+        args.o->fields["seq"] = protocol::MakeNumber(123456789);
+        args.o->fields["flag"] = protocol::MakeBool(true);
+        doc.o->fields["args"] = std::move(args);
+
+        auto json = std::make_shared<std::string>();
+        protocol::SerializeJson(doc, *json);
+        out.push_back({"json/parse/" + SizeLabel(n), json->size(), [json](size_t iters) {
+            protocol::JsonValue v;
+            for (size_t i = 0; i < iters; ++i) {
+                protocol::ParseJson(*json, v, kBenchLimits);
+                KeepAlive(v);
+            }
+        }});
+
+        auto value = std::make_shared<protocol::JsonValue>(std::move(doc));
+        out.push_back({"json/serialize/" + SizeLabel(n), json->size(), [value](size_t iters) {
+            std::string s;
+            for (size_t i = 0; i < iters; ++i) {
+                s.clear();
+                protocol::SerializeJson(*value, s);
+                KeepAlive(s);
+            }
+        }});
+    }
+}
+
+void AddMessageBenchmarks(std::vector<Benchmark>& out) {
+    for (size_t n : {64, 1024, 16384, 65536}) {
+        auto frame = std::make_shared<std::string>();
+        protocol::EncodeRequest(MakeEchoRequest(n), *frame);
+        out.push_back({"message/decode_request/" + SizeLabel(n), frame->size(), [frame](size_t iters) {
+            protocol::JsonDocument doc;
+            protocol::RequestMessage req;
+            protocol::ErrorCode err = protocol::ErrorCode::Ok;
+            for (size_t i = 0; i < iters; ++i) {
+                protocol::DecodeRequest(*frame, doc, req, err);
+                KeepAlive(req);
+            }
+        }});
+
+        auto resp = std::make_shared<protocol::ResponseMessage>();
+        resp->ok = true;
+        resp->code = protocol::ErrorCode::Ok;
+        resp->msg = "OK";
+        resp->data.fields["echo"] = protocol::MakeString(MakeText(n, 13));
+        std::string sized;
+        protocol::EncodeResponse(*resp, sized);
+        out.push_back({"message/encode_response/" + SizeLabel(n), sized.size(), [resp](size_t iters) {
+            std::string s;
+            for (size_t i = 0; i < iters; ++i) {
+                net::beginFrame(s);
+                protocol::AppendResponse(*resp, s);
+                KeepAlive(s);
+            }
+        }});
+    }
+}
+
+void AddBase64Benchmarks(std::vector<Benchmark>& out) {
+    for (size_t n : {64, 1024, 16384, 65536}) {
+        auto raw = std::make_shared<std::vector<uint8_t>>(MakeBytes(n, 17));
+        out.push_back({"base64/encode/" + SizeLabel(n), n, [raw](size_t iters) {
+            std::string s(util::Base64EncodedSize(raw->size()), '\0');
+            for (size_t i = 0; i < iters; ++i) {
+                util::Base64Encode(raw->data(), raw->size(), s.data());
+                KeepAlive(s);
+            }
+        }});
+
+        auto text = std::make_shared<std::string>(util::Base64Encode(*raw));
+        out.push_back({"base64/decode/" + SizeLabel(n), n, [text](size_t iters) {
+            std::vector<uint8_t> buf(util::Base64DecodedMaxSize(text->size()));
+            size_t len = 0;
+            for (size_t i = 0; i < iters; ++i) {
+                util::Base64Decode(text->data(), text->size(), buf.data(), buf.size(), len);
+                KeepAlive(buf);
+            }
+        }});
+    }
+}
+
+void AddHexBenchmarks(std::vector<Benchmark>& out) {
+    for (size_t n : {8, 256, 4096}) {
+        auto raw = std::make_shared<std::vector<uint8_t>>(MakeBytes(n, 19));
+        out.push_back({"hex/bytes_to_hex/" + SizeLabel(n), n, [raw](size_t iters) {
+            for (size_t i = 0; i < iters; ++i) {
+                std::string s = crypto::BytesToHex(*raw);
+                KeepAlive(s);
+            }
+        }});
+
+        auto hex = std::make_shared<std::string>(crypto::BytesToHex(*raw));
+        out.push_back({"hex/hex_to_bytes/" + SizeLabel(n), n, [hex](size_t iters) {
+            std::vector<uint8_t> bytes;
+            for (size_t i = 0; i < iters; ++i) {
+                crypto::HexToBytes(*hex, bytes);
+                KeepAlive(bytes);
+            }
+        }});
+    }
+}
+
+// Decode + route + handler + encode, as a session thread runs them minus
+// the socket I/O.
+struct RouterBench {
+    server::CommandRouter router;
+    server::Session session;
+    server::RequestContext ctx;
+    std::string frame;
+
+    void Run(size_t iters) {
+        for (size_t i = 0; i < iters; ++i) {
+            ctx.frame = frame;
+            ctx.Decode();
+            router.Handle(session, ctx);
+            router.Complete(ctx);
+            KeepAlive(ctx.out);
+        }
+    }
+};
+
+void AddRouterBenchmarks(std::vector<Benchmark>& out) {
+    server::BuildStaticReplies();
+    auto add = [&out](const std::string& name, const protocol::RequestMessage& req, bool cacheHelp) {
+        auto bench = std::make_shared<RouterBench>();
+        server::RegisterBasicHandlers(bench->router);
+        if (cacheHelp) {
+            bench->router.cache().Enable(server::CommandId::Help, {});
+        }
+        protocol::EncodeRequest(req, bench->frame);
+        out.push_back({"router/handle/" + name, bench->frame.size(), [bench](size_t iters) {
+            bench->Run(iters);
+        }});
+    };
+
+    protocol::RequestMessage ping;
+    ping.cmd = "PING";
+    add("ping", ping, false);
+    protocol::RequestMessage help;
+    help.cmd = "HELP";
+    add("help", help, false);
+    add("help_cached", help, true);
+    for (size_t n : {64, 1024, 16384}) {
+        add("echo/" + SizeLabel(n), MakeEchoRequest(n), false);
+    }
+}
+
+double TimeNs(const Benchmark& b, size_t iters) {
+    const Clock::time_point start = Clock::now();
+    b.run(iters);
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+Result Measure(const Benchmark& b, const BenchArgs& args) {
+    // Warm up, then grow the batch until it is long enough to time reliably.
+    size_t iters = 1;
+    double ns = TimeNs(b, iters);
+    while (ns < 10e6 && iters < (size_t{1} << 40)) {
+        iters *= 2;
+        ns = TimeNs(b, iters);
+    }
+    const double perOp = ns / static_cast<double>(iters);
+    iters = std::max<size_t>(1, static_cast<size_t>(args.minTimeMs * 1e6 / perOp));
+
+    std::vector<double> samples;
+    for (uint32_t r = 0; r < args.repetitions; ++r) {
+        samples.push_back(TimeNs(b, iters) / static_cast<double>(iters));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result res;
+    res.name = b.name;
+    res.bytes = b.bytes;
+    res.nsPerOp = samples[samples.size() / 2];
+    res.spreadPct = res.nsPerOp > 0 ? (samples.back() - samples.front()) * 100.0 / res.nsPerOp : 0;
+    return res;
+}
+
+// Baselines hold integer picoseconds per op, since JsonLite numbers are
+// integers.
+bool SaveBaseline(const std::string& path, const std::vector<Result>& results) {
+    std::string json = "{\"build\":\"";
+    json += kBuildFlavor;
+    json += "\",\"results\":{";
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i) {
+            json += ',';
+        }
+        json += "\n\"" + results[i].name + "\":";
+        protocol::AppendJsonNumber(static_cast<int64_t>(results[i].nsPerOp * 1000), json);
+    }
+    json += "\n}}\n";
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    fout << json;
+    return static_cast<bool>(fout);
+}
+
+bool LoadBaseline(const std::string& path, std::string& build, protocol::JsonObject& results, std::string& err) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) {
+        err = "cannot open " + path;
+        return false;
+    }
+    std::ostringstream oss;
+    oss << fin.rdbuf();
+    protocol::JsonValue root;
+    const protocol::JsonLimits limits{4 * 1024 * 1024, 1024, 4096, 64, 4};
+    if (!protocol::ParseJson(oss.str(), root, limits) || root.type != protocol::JsonValue::Type::Object ||
+        !root.o) {
+        err = "invalid baseline json";
+        return false;
+    }
+    protocol::GetString(*root.o, "build", build);
+    const protocol::JsonObject* found = protocol::FindObject(*root.o, "results");
+    if (!found) {
+        err = "baseline has no results";
+        return false;
+    }
+    results = *found;
+    return true;
+}
+
+std::string FormatNs(double ns) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(ns < 100 ? 2 : 1) << ns;
+    return oss.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchArgs args;
+    if (!ParseArgs(argc, argv, args)) {
+        PrintUsage();
+        return 1;
+    }
+    if (args.showHelp) {
+        PrintUsage();
+        return 0;
+    }
+    util::Logger::setLevel(util::LogLevel::Warn);
+
+    std::vector<Benchmark> all;
+    AddJsonBenchmarks(all);
+    AddMessageBenchmarks(all);
+    AddBase64Benchmarks(all);
+    AddRouterBenchmarks(all);
+    AddHexBenchmarks(all);
+
+    std::vector<const Benchmark*> selected;
+    for (const Benchmark& b : all) {
+        if (args.filter.empty() || b.name.find(args.filter) != std::string::npos) {
+            selected.push_back(&b);
+        }
+    }
+    if (args.list) {
+        for (const Benchmark* b : selected) {
+            std::cout << b->name << "\n";
+        }
+        return 0;
+    }
+
+    std::string baseBuild;
+    protocol::JsonObject baseline;
+    const bool comparing = !args.comparePath.empty();
+    if (comparing) {
+        std::string err;
+        if (!LoadBaseline(args.comparePath, baseBuild, baseline, err)) {
+            std::cerr << "Baseline error: " << err << "\n";
+            return 1;
+        }
+        if (baseBuild != kBuildFlavor) {
+            std::cerr << "warning: baseline is a " << baseBuild << " build, this is a " << kBuildFlavor
+                      << " build\n";
+        }
+    }
+    if (std::string_view(kBuildFlavor) == "debug") {
+        std::cerr << "warning: debug build, numbers are not representative\n";
+    }
+
+    std::cout << std::left << std::setw(34) << "benchmark" << std::right << std::setw(12) << "ns/op"
+              << std::setw(10) << "MB/s" << std::setw(9) << "spread";
+    if (comparing) {
+        std::cout << std::setw(12) << "base ns/op" << std::setw(9) << "delta";
+    }
+    std::cout << "\n";
+
+    std::vector<Result> results;
+    size_t regressions = 0;
+    for (const Benchmark* b : selected) {
+        const Result r = Measure(*b, args);
+        results.push_back(r);
+
+        std::cout << std::left << std::setw(34) << r.name << std::right << std::setw(12) << FormatNs(r.nsPerOp);
+        if (r.bytes != 0) {
+            std::cout << std::setw(10) << std::fixed << std::setprecision(0) << r.bytes * 1e3 / r.nsPerOp;
+        } else {
+            std::cout << std::setw(10) << "-";
+        }
+        std::cout << std::setw(8) << std::fixed << std::setprecision(1) << r.spreadPct << "%";
+
+        int64_t basePs = 0;
+        if (comparing && protocol::GetNumber(baseline, r.name, basePs) && basePs > 0) {
+            const double baseNs = static_cast<double>(basePs) / 1000;
+            const double delta = (r.nsPerOp - baseNs) * 100.0 / baseNs;
+            std::cout << std::setw(12) << FormatNs(baseNs) << std::setw(8) << std::showpos << std::setprecision(1)
+                      << delta << "%" << std::noshowpos;
+            if (delta > args.thresholdPct) {
+                std::cout << "  REGRESSION";
+                ++regressions;
+            } else if (delta < -args.thresholdPct) {
+                std::cout << "  improved";
+            }
+        } else if (comparing) {
+            std::cout << std::setw(12) << "-" << std::setw(9) << "new";
+        }
+        std::cout << "\n";
+    }
+
+    if (!args.savePath.empty()) {
+        if (!SaveBaseline(args.savePath, results)) {
+            std::cerr << "failed to write " << args.savePath << "\n";
+            return 1;
+        }
+        std::cout << "baseline saved to " << args.savePath << "\n";
+    }
+    if (comparing) {
+        std::cout << regressions << " regression(s) over " << args.thresholdPct << "%\n";
+        return regressions == 0 ? 0 : 2;
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../common/protocol/ErrorCode.h"
+#include "../../common/utils/EventLog.h"
+#include "../../server/core/CommandTable.h"
+
+// Renders server event logs (see common/utils/EventLog.h) as text or JSON
+// lines. Records are read in host byte order, like the server writes them.
+
+namespace {
+
+struct DumpArgs {
+    bool json = false;
+    bool showHelp = false;
+    std::vector<std::string> files;
+};
+
+void PrintUsage() {
+    std::cout << "Usage: EventDump [--json] <event_log> [more files...]\n";
+}
+
+bool ParseArgs(int argc, char** argv, DumpArgs& out) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            out.showHelp = true;
+            return true;
+        }
+        if (arg == "--json") {
+            out.json = true;
+            continue;
+        }
+        if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return false;
+        }
+        out.files.emplace_back(arg);
+    }
+    if (out.files.empty()) {
+        std::cerr << "No event log given\n";
+        return false;
+    }
+    return true;
+}
+
+std::string_view CommandLabel(uint16_t cmd) {
+    if (cmd < server::kCommandCount) {
+        return server::CommandName(static_cast<server::CommandId>(cmd));
+    }
+    return "OTHER";
+}
+
+std::string FormatTime(uint64_t timeUs) {
+    const std::time_t tt = static_cast<std::time_t>(timeUs / 1000000);
+    std::tm tm{};
+    localtime_s(&tm, &tt);
+    char buf[48];
+    const size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    std::snprintf(buf + n, sizeof(buf) - n, ".%06u", static_cast<unsigned>(timeUs % 1000000));
+    return buf;
+}
+
+void PrintRecord(const util::EventRecord& rec, bool json) {
+    const protocol::ErrorCode code = protocol::ErrorCodeFromInt(rec.code);
+    if (json) {
+        std::cout << "{\"time_us\":" << rec.timeUs
+                  << ",\"conn\":" << rec.connId
+                  << ",\"cmd\":\"" << CommandLabel(rec.cmd) << "\""
+                  << ",\"code\":" << rec.code
+                  << ",\"bytes_in\":" << rec.bytesIn
+                  << ",\"bytes_out\":" << rec.bytesOut
+                  << ",\"latency_us\":" << rec.latencyUs
+                  << "}\n";
+        return;
+    }
+    std::cout << FormatTime(rec.timeUs)
+              << " conn=" << rec.connId
+              << " cmd=" << CommandLabel(rec.cmd)
+              << " code=" << rec.code << "(" << protocol::ErrorCodeToString(code) << ")"
+              << " in=" << rec.bytesIn
+              << " out=" << rec.bytesOut
+              << " latency_us=" << rec.latencyUs
+              << "\n";
+}
+
+bool DumpFile(const std::string& path, bool json, uint64_t& count) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+        std::cerr << path << ": cannot open\n";
+        return false;
+    }
+    util::EventLogHeader header;
+    if (!fin.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, util::kEventLogMagic, sizeof(header.magic)) != 0) {
+        std::cerr << path << ": not an event log\n";
+        return false;
+    }
+    if (header.version != 1 || header.recordSize < sizeof(util::EventRecord)) {
+        std::cerr << path << ": unsupported version " << header.version << "\n";
+        return false;
+    }
+
+    // Newer writers may append fields; read what this version knows.
+    std::vector<char> buf(header.recordSize);
+    while (fin.read(buf.data(), static_cast<std::streamsize>(buf.size()))) {
+        util::EventRecord rec;
+        std::memcpy(&rec, buf.data(), sizeof(rec));
+        if (rec.timeUs == 0) {
+            break; // preallocated space the server never reached
+        }
+        PrintRecord(rec, json);
+        ++count;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    DumpArgs args;
+    if (!ParseArgs(argc, argv, args)) {
+        PrintUsage();
+        return 1;
+    }
+    if (args.showHelp) {
+        PrintUsage();
+        return 0;
+    }
+
+    bool ok = true;
+    uint64_t count = 0;
+    for (const auto& path : args.files) {
+        ok = DumpFile(path, args.json, count) && ok;
+    }
+    std::cerr << count << " records\n";
+    return ok ? 0 : 1;
+}